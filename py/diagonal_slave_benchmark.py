@@ -0,0 +1,27 @@
+#!/usr/bin/env python
+
+import launch
+import copy
+import os
+
+"""
+Copies the configs for the full Gurobi slave and the compact diagonal slave.
+Both start from the same warm start, so the first iterations price the same duals.
+The diagonal slave runs alone in a thread of opt, so the full slave runs as a single async slave to compare the formulations.
+"""
+def both_formulations(c):
+    l = []
+    cpy = copy.deepcopy(c)
+    cpy.extra_args += " --slaves 1"
+    cpy.output_file += "_full_slave"
+    l.append(cpy)
+
+    cpy = copy.deepcopy(c)
+    cpy.extra_args += " --diagonal_slave"
+    cpy.output_file += "_diagonal_slave"
+    l.append(cpy)
+    return l
+
+os.environ.setdefault("FOLDER", "diagonal_slave_benchmarks")
+
+executions = launch.launch(extra_config_generator=both_formulations)
@@ -0,0 +1,26 @@
+#!/usr/bin/env python
+
+import launch
+import copy
+import os
+
+"""
+Copies the configs for the Gurobi slaves and the geometric branch-and-bound slave.
+Both start from the same warm start, so the first iterations price the same duals.
+The geometric slave runs alone in a thread of opt, the Gurobi slaves as configured.
+"""
+def both_slaves(c):
+    l = []
+    cpy = copy.deepcopy(c)
+    cpy.output_file += "_grb_slave"
+    l.append(cpy)
+
+    cpy = copy.deepcopy(c)
+    cpy.extra_args += " --geometric_slave"
+    cpy.output_file += "_geometric_slave"
+    l.append(cpy)
+    return l
+
+os.environ.setdefault("FOLDER", "geometric_slave_benchmarks")
+
+executions = launch.launch(extra_config_generator=both_slaves)
@@ -9,7 +9,7 @@ import sys
 #import matplotlib.pyplot as plt
 
 """
-Copies the configs for every solver method (simplex, dual simplex and barrier).
+Copies the configs for every solver method (simplex, dual simplex and barrier) and for the adaptive method selection.
 """
 def multiple_solvers(c):
     l = []
@@ -19,6 +19,11 @@ def multiple_solvers(c):
         cpy.output_file += "_" + str(solver)
         l.append(cpy)
 
+    cpy = copy.deepcopy(c)
+    cpy.extra_args += " --adaptive_master_solver --no_warm_start_values --slow_warm_start"
+    cpy.output_file += "_adaptive"
+    l.append(cpy)
+
     cpy = copy.deepcopy(c)
     cpy.extra_args += " --no_warm_start_values "
     cpy.output_file += ".all_columns_at_once"
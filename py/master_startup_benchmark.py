@@ -0,0 +1,55 @@
+#!/usr/bin/env python
+
+import launch
+import copy
+import os
+
+"""
+Creates a config with named and one with unnamed master slacks.
+"""
+def names_adder(c):
+    l = []
+    for no_names in [False, True]:
+        cpy = copy.deepcopy(c)
+        if no_names:
+            cpy.extra_args += " --no_master_names "
+            cpy.output_file += "_no_master_names"
+        l.append(cpy)
+    return l
+
+"""
+Returns the first row of a ;-separated statistics file.
+"""
+def first_row(filename):
+    with open(filename) as f:
+        for line in f:
+            if not line.startswith("#"):
+                return [float(x) for x in line.split(";") if len(x.strip()) > 0]
+    return None
+
+"""
+Prints the time to build the master and the time for its first solve.
+The first master_time (.times) contains building and solving, the solve time is the elapsed_run_time of Gurobi (.masterstats).
+"""
+def report(configs):
+    print("run;build_time;solve_time")
+    for c in configs:
+        times = first_row(c.output_file + ".times")
+        stats = first_row(c.output_file + ".masterstats")
+        if times is None or stats is None:
+            print(str(c.output_file) + ";failed;failed")
+            continue
+        print(str(c.output_file) + ";" + str(times[0] - stats[1]) + ";" + str(stats[1]))
+
+def main():
+    os.environ.setdefault("FOLDER", "master_startup_benchmarks")
+    os.environ.pop("SAFT", "")
+    os.environ.setdefault("MAX_COLUMNS", "0")
+    executions = launch.launch([
+        "./configs/benchmark.csv",
+        ], names_adder)
+    if executions:
+        report(executions)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,26 @@
+#!/usr/bin/env python
+
+import launch
+import copy
+import os
+
+"""
+Copies the configs for the async loop with one slave restart per dual and for the pipelined loop.
+The .times files contain the master wait time and the busy time of all slaves per iteration in their last two columns.
+"""
+def pipelined(c):
+    l = []
+    cpy = copy.deepcopy(c)
+    cpy.output_file += "_one_slave_per_dual"
+    l.append(cpy)
+
+    for batch in [1, 4]:
+        cpy = copy.deepcopy(c)
+        cpy.extra_args += " --pipeline_batch " + str(batch)
+        cpy.output_file += "_pipeline_batch_" + str(batch)
+        l.append(cpy)
+    return l
+
+os.environ.setdefault("FOLDER", "pipeline_benchmarks")
+
+executions = launch.launch(extra_config_generator=pipelined)
@@ -0,0 +1,31 @@
+#!/usr/bin/env python
+
+import launch
+import copy
+import os
+
+"""
+Creates a config using grb_master and one using simplex_master.
+"""
+def master_adder(c):
+    l = []
+    for in_house in [False, True]:
+        cpy = copy.deepcopy(c)
+        if in_house:
+            cpy.extra_args += " --in_house_master "
+            cpy.output_file += "_in_house_master"
+        l.append(cpy)
+    return l
+
+"""
+Compares the master time (see the .times files) of grb_master and simplex_master.
+"""
+def main():
+    os.environ.setdefault("FOLDER", "benchmarks")
+    os.environ.setdefault("MAX_COLUMNS", "400")
+    launch.launch([
+        "./configs/benchmark.csv",
+        ], master_adder)
+
+if __name__ == "__main__":
+    main()
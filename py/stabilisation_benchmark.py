@@ -0,0 +1,56 @@
+#!/usr/bin/env python
+
+import launch
+import copy
+import glob
+import os
+
+modes = ["none", "wentges", "in_out", "box_step"]
+
+"""
+Creates one config per dual stabilisation mode.
+"""
+def stabilisation_adder(c):
+    l = []
+    for mode in range(len(modes)):
+        cpy = copy.deepcopy(c)
+        cpy.extra_args += " --stabilisation " + str(mode) + " "
+        cpy.output_file += "_" + modes[mode]
+        cpy.stabilisation = mode
+        l.append(cpy)
+    return l
+
+"""
+Returns the number of master runs (= CG iterations) of one run.
+"""
+def iterations(c):
+    try:
+        with open(c.output_file + ".masterstats") as f:
+            return len([line for line in f if not line.startswith("#")])
+    except IOError:
+        return None
+
+"""
+Prints the CG iterations of every mode and the iterations saved compared to the unstabilised run.
+"""
+def report(configs):
+    print("run;mode;iterations;saved")
+    unstabilised = {}
+    for c in configs:
+        if c.stabilisation == 0:
+            unstabilised[c.input_file] = iterations(c)
+    for c in configs:
+        current = iterations(c)
+        base = unstabilised.get(c.input_file)
+        saved = base - current if base is not None and current is not None else None
+        print(str(c.input_file) + ";" + modes[c.stabilisation] + ";" + str(current) + ";" + str(saved))
+
+def main():
+    os.environ.setdefault("FOLDER", "stabilisation_benchmarks")
+    os.environ.pop("SAFT", "")
+    executions = launch.launch(sorted(glob.glob("./configs/*.csv")), stabilisation_adder)
+    if executions:
+        report(executions)
+
+if __name__ == "__main__":
+    main()
@@ -1,4 +1,5 @@
 #include "optlib/cgdump_analyser.h"
+#include "optlib/column_cache.h"
 #include "optlib/column_generation.h"
 #include "optlib/config.h"
 #include "optlib/exception.h"
@@ -52,6 +53,35 @@ const struct option options[] = {
     { "no_randomisation", no_argument, nullptr, '-' },
     { "no_rounding_down", no_argument, nullptr, '=' },
     { "no_tangents", no_argument, nullptr, ']' },
+    { "in_house_master", no_argument, nullptr, '>' },
+    { "pdhg_master", no_argument, nullptr, '{' },
+    { "pdhg_polish", no_argument, nullptr, '}' },
+    { "no_master_names", no_argument, nullptr, '~' },
+    { "column_pool", required_argument, nullptr, '|' },
+    { "column_pool_age", required_argument, nullptr, ';' },
+    { "stabilisation", required_argument, nullptr, '0' },
+    { "stabilisation_alpha", required_argument, nullptr, '1' },
+    { "stabilisation_box", required_argument, nullptr, '2' },
+    { "relative_gap", required_argument, nullptr, '3' },
+    { "amplitude_bound", required_argument, nullptr, '4' },
+    { "adaptive_master_solver", no_argument, nullptr, '5' },
+    { "adaptive_exploration", required_argument, nullptr, '6' },
+    { "lazy_rows", required_argument, nullptr, '7' },
+    { "slave_presolve", no_argument, nullptr, '8' },
+    { "dual_saft", required_argument, nullptr, '9' },
+    { "dual_saft_columns", required_argument, nullptr, ',' },
+    { "geometric_slave", no_argument, nullptr, '.' },
+    { "diagonal_slave", no_argument, nullptr, '\'' },
+    { "slave_portfolio", no_argument, nullptr, 'P' },
+    { "strip_overlap", required_argument, nullptr, 'D' },
+    { "pool_capacity", required_argument, nullptr, 'B' },
+    { "column_cache", required_argument, nullptr, 'A' },
+    { "column_cache_size", required_argument, nullptr, 'E' },
+    { "pipeline_batch", required_argument, nullptr, 'F' },
+    { "pipeline_wait", required_argument, nullptr, 'G' },
+    { "pipeline_dual_age", required_argument, nullptr, 'H' },
+    { "local_search", required_argument, nullptr, '/' },
+    { "local_search_steps", required_argument, nullptr, '`' },
     { 0, 0, 0, 0 },
 };
 const char* short_options = "hvf:g:m:t:x:p:r:c:e:l:s:a:o:S:o:C:w:W:nR:?:!:#:";
@@ -216,9 +246,9 @@ main(int argc, char** argv)
             }
             case '!': {
                 master_solver = (master_problem::solver)std::stoi(optarg);
-                assert_that(master_solver >= 0 && master_solver <= 2,
-                            "Only 3 solvers available : Simplex(0), Dual "
-                            "Simplex(1) and Barrier(2)");
+                assert_that(master_solver >= 0 && master_solver <= 3,
+                            "Only 4 solvers available : Simplex(0), Dual "
+                            "Simplex(1), Barrier(2) and Concurrent(3)");
                 break;
             }
             case '@': {
@@ -229,6 +259,122 @@ main(int argc, char** argv)
                 slow_warm_start = true;
                 break;
             }
+            case '>': {
+                c.in_house_master = true;
+                break;
+            }
+            case '{': {
+                c.pdhg_master = true;
+                break;
+            }
+            case '}': {
+                c.pdhg_polish = true;
+                break;
+            }
+            case '~': {
+                c.no_master_names = true;
+                break;
+            }
+            case '|': {
+                c.column_pool_size = std::stoul(optarg);
+                break;
+            }
+            case ';': {
+                c.column_pool_age = std::stoul(optarg);
+                break;
+            }
+            case '0': {
+                c.stabilisation = std::stoul(optarg);
+                break;
+            }
+            case '1': {
+                c.stabilisation_alpha = std::stod(optarg);
+                break;
+            }
+            case '2': {
+                c.stabilisation_box = std::stod(optarg);
+                break;
+            }
+            case '3': {
+                c.relative_gap = std::stod(optarg);
+                break;
+            }
+            case '4': {
+                c.amplitude_bound = std::stod(optarg);
+                break;
+            }
+            case '5': {
+                c.adaptive_master_solver = true;
+                break;
+            }
+            case '6': {
+                c.adaptive_exploration = std::stoul(optarg);
+                break;
+            }
+            case '7': {
+                c.lazy_rows = std::stod(optarg);
+                break;
+            }
+            case '8': {
+                c.slave_presolve = true;
+                break;
+            }
+            case '9': {
+                c.dual_saft_resolution = std::stoul(optarg);
+                break;
+            }
+            case ',': {
+                c.dual_saft_columns = std::stoul(optarg);
+                break;
+            }
+            case '.': {
+                c.geometric_slave = true;
+                break;
+            }
+            case '\'': {
+                c.diagonal_slave = true;
+                break;
+            }
+            case 'P': {
+                c.slave_portfolio = true;
+                break;
+            }
+            case 'D': {
+                c.strip_overlap = std::stod(optarg);
+                break;
+            }
+            case 'B': {
+                c.pool_capacity = std::stoul(optarg);
+                break;
+            }
+            case 'A': {
+                c.column_cache_directory = optarg;
+                break;
+            }
+            case 'E': {
+                c.column_cache_size = std::stoul(optarg);
+                break;
+            }
+            case 'F': {
+                c.pipeline_batch = std::stoul(optarg);
+                break;
+            }
+            case 'G': {
+                c.pipeline_wait = std::stod(optarg);
+                break;
+            }
+            case 'H': {
+                c.pipeline_dual_age = std::stoul(optarg);
+                break;
+            }
+            case '/': {
+                c.local_search_radius = std::stoul(optarg);
+                break;
+            }
+            case '`': {
+                c.local_search_steps = std::stoul(optarg);
+                break;
+            }
             case '#':
             case 'w': {
                 const bool for_master = current == 'w';
@@ -459,6 +605,37 @@ main(int argc, char** argv)
     cg = std::make_unique<grb_cg_multi_slaves>(
       c, measurement, trimmed_reference, slaves, slave_cuts, cb_options);
 
+    std::optional<column_cache> cache;
+    std::string cache_file;
+    if (!c.column_cache_directory.empty()) {
+        cache.emplace(c, c.column_cache_size);
+        cache_file =
+          c.column_cache_directory + "/" + cache->key() + ".colcache";
+        std::ifstream is(cache_file);
+        if (is && cache->load(is)) {
+            // pre-price against sign(m), the optimal dual of the master without variables.
+            arr<> initial_dual(
+              measurement.dim1, measurement.dim2, measurement.dim3);
+            initial_dual.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+                return measurement(i, j, k) >= 0.0 ? 1.0 : -1.0;
+            });
+            const unsigned found = cache->lookup(
+              [&](const time_of_flight& tof) {
+                  return tof.dot_product_with_dual(
+                    trimmed_reference, initial_dual, c.get_roi_start());
+              },
+              c.slave_threshold,
+              master_warm_start);
+            master_warm_start_values.resize(master_warm_start.size(), 0.0);
+            if (c.verbose) {
+                std::cout << "Warm start with " << found << " of "
+                          << cache->entries().size()
+                          << " columns from the column cache " << cache_file
+                          << std::endl;
+            }
+        }
+    }
+
     roi{ c.get_roi_start(), c.get_roi_end() }.filter_tofs_to(
       master_warm_start,
       master_warm_start_values,
@@ -479,5 +656,17 @@ main(int argc, char** argv)
 
     cg->run(start_values, reflectors, amplitude);
 
+    if (cache) {
+        for (unsigned i = 0; i < reflectors.size() && i < amplitude.size();
+             i++) {
+            if (amplitude[i] > 0.0) {
+                cache->store(reflectors[i]);
+            }
+        }
+        ofstream_with_dirs os(cache_file);
+        assert_that(cache->save(os),
+                    "Could not write the column cache " + cache_file + "!");
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "adaptive_solver.h"
+#include "exception.h"
+#include <algorithm>
+
+adaptive_solver::adaptive_solver(std::vector<master_problem::solver> methods,
+                                 unsigned exploration_interval,
+                                 double smoothing)
+  : methods(methods)
+  , exploration_interval(exploration_interval)
+  , smoothing(smoothing)
+{
+    assert_that(!methods.empty(), "The adaptive solver needs some methods!");
+    assert_that(smoothing > 0.0 && smoothing <= 1.0,
+                "The smoothing has to be in (0, 1]!");
+    for (auto& runtime : runtimes) {
+        runtime.resize(methods.size());
+    }
+}
+
+master_problem::solver
+adaptive_solver::next(context c)
+{
+    const unsigned solve = solves[c]++;
+
+    // measure every method once
+    for (unsigned m = 0; m < methods.size(); m++) {
+        if (!runtimes[c][m]) {
+            return methods[m];
+        }
+    }
+
+    const master_problem::solver best = fastest(c);
+    if (methods.size() == 1 || exploration_interval == 0 ||
+        solve % exploration_interval != 0) {
+        return best;
+    }
+
+    // round robin over all other methods
+    unsigned& index = next_exploration[c];
+    index = (index + 1) % methods.size();
+    if (methods[index] == best) {
+        index = (index + 1) % methods.size();
+    }
+    return methods[index];
+}
+
+void
+adaptive_solver::record(context c, master_problem::solver method, double runtime)
+{
+    const auto it = std::find(methods.begin(), methods.end(), method);
+    if (it == methods.end()) {
+        return;
+    }
+    std::optional<double>& current = runtimes[c][it - methods.begin()];
+    if (current) {
+        *current = smoothing * runtime + (1.0 - smoothing) * *current;
+    } else {
+        current = runtime;
+    }
+}
+
+master_problem::solver
+adaptive_solver::fastest(context c) const
+{
+    unsigned best = 0;
+    for (unsigned m = 1; m < methods.size(); m++) {
+        if (runtimes[c][m] &&
+            (!runtimes[c][best] || *runtimes[c][m] < *runtimes[c][best])) {
+            best = m;
+        }
+    }
+    return methods[best];
+}
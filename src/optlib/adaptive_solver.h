@@ -0,0 +1,51 @@
+#ifndef ADAPTIVE_SOLVER_H
+#define ADAPTIVE_SOLVER_H
+
+#include "master.h"
+#include <optional>
+#include <vector>
+
+///@brief Chooses the solver method of the master for every solve from the measured runtimes.
+///
+/// Re-solves after adding columns and re-solves after a clean behave differently (the primal simplex keeps a feasible basis
+/// when columns are added, the dual simplex when columns are removed), so both contexts are timed separately.
+/// Every method is tried once per context, afterwards the fastest one (exponentially smoothed runtime) is used and every
+/// exploration_interval-th solve tries one of the others again.
+struct adaptive_solver
+{
+    enum context : unsigned
+    {
+        AFTER_ADD = 0,
+        AFTER_CLEAN = 1,
+        CONTEXTS = 2,
+    };
+
+    /// An exploration_interval of 0 disables the exploration after every method was measured once.
+    adaptive_solver(std::vector<master_problem::solver> methods,
+                    unsigned exploration_interval,
+                    double smoothing = 0.5);
+
+    std::vector<master_problem::solver> methods;
+    unsigned exploration_interval;
+    /// Weight of the newest runtime in the smoothed runtime.
+    double smoothing;
+
+    /// Smoothed runtime of every method per context, not set before the first measurement.
+    std::vector<std::optional<double>> runtimes[CONTEXTS];
+
+    /// Number of solves per context.
+    unsigned solves[CONTEXTS] = { 0, 0 };
+    /// Index of the method tried in the next exploration per context.
+    unsigned next_exploration[CONTEXTS] = { 0, 0 };
+
+    /// Returns the method to use for the next solve in context c.
+    master_problem::solver next(context c);
+
+    /// Adds the runtime (in seconds) of a solve in context c done with method.
+    void record(context c, master_problem::solver method, double runtime);
+
+    /// Returns the method with the smallest smoothed runtime in context c (the first method if none was measured).
+    master_problem::solver fastest(context c) const;
+};
+
+#endif
@@ -281,6 +281,54 @@ symmetric_arr<ARR, unsymmetric_index>::index(unsigned i,
     return (j - i + gauss(dim1) - gauss(dim1 - i)) * dim3 + k;
 }
 
+/// @brief Array that only stores the diagonal of its two symmetric dimensions.
+///
+/// With free_index = 2, (i, i, k) is stored (like symmetric_arr without the off-diagonal), with free_index = 0 only (0, i, i) is stored.
+/// Accessing an off-diagonal entry is an error.
+template<typename ARR, int free_index = 2>
+class diagonal_arr : public ARR
+{
+  public:
+    using ARR::ARR;
+    virtual unsigned index(unsigned i, unsigned j, unsigned k) const override;
+    unsigned size() const override;
+    static unsigned size(struct size s);
+};
+
+template<typename ARR, int free_index>
+unsigned
+diagonal_arr<ARR, free_index>::size(struct size s)
+{
+    if (free_index == 0) {
+        assert(s.dim2 == s.dim3);
+        return s.dim1 * s.dim2;
+    } else {
+        assert(free_index == 2 && s.dim1 == s.dim2);
+        return s.dim1 * s.dim3;
+    }
+}
+
+template<typename ARR, int free_index>
+unsigned
+diagonal_arr<ARR, free_index>::size() const
+{
+    return size(*this);
+}
+
+template<typename ARR, int free_index>
+unsigned
+diagonal_arr<ARR, free_index>::index(unsigned i, unsigned j, unsigned k) const
+{
+    if (free_index == 0) {
+        assert(j == k && j < this->dim2 && "off-diagonal or out of bounds!");
+        return i * this->dim2 + j;
+    } else {
+        assert(i == j && i < this->dim1 && k < this->dim3 &&
+               "off-diagonal or out of bounds!");
+        return i * this->dim3 + k;
+    }
+}
+
 /// Some proxy_arr but exclusively for numbers. Can print, add, substract, ...
 template<typename T = double>
 class arr : public proxy_arr<T>
@@ -0,0 +1,171 @@
+#include "column_cache.h"
+#include "csv_tools.h"
+#include <sstream>
+
+column_cache::column_cache(const config& c, unsigned capacity)
+  : capacity(capacity)
+  , c(c)
+{}
+
+std::string
+column_cache::key() const
+{
+    std::ostringstream ss;
+    ss << "pitch" << c.pitch << "_elements" << c.elements << "_speed"
+       << c.wave_speed << "_rate" << c.sampling_rate << "_roi"
+       << c.get_roi_start() << "-" << c.get_roi_end();
+    return ss.str();
+}
+
+bool
+column_cache::load(std::istream& is)
+{
+    std::string header;
+    std::getline(is, header);
+    std::istringstream hs(header);
+    std::string key_of_file;
+    std::getline(hs, key_of_file, ';');
+    if (!is || key_of_file != "#" + key()) {
+        return false;
+    }
+    hs >> runs;
+
+    unsigned last_used;
+    while (is >> last_used, is) {
+        semi(is);
+        entry e{
+            last_used, 0.0, 0.0, 0.0, time_of_flight(c.elements, c.elements, {})
+        };
+        extract_with_semicolon(is, e.x);
+        extract_with_semicolon(is, e.y);
+        extract_with_semicolon(is, e.probe_x);
+        for (unsigned j = 0; j < c.elements; j++) {
+            for (unsigned k = 0; k < c.elements; k++) {
+                extract_with_semicolon(is, e.tof.at(j, k));
+            }
+        }
+        assert_read(is, "Truncated column cache!");
+        _entries.push_back(std::move(e));
+        nextline(is);
+    }
+    return true;
+}
+
+bool
+column_cache::save(std::ostream& os)
+{
+    // most recently used first, stable to keep the older columns of a run in order.
+    std::stable_sort(_entries.begin(),
+                     _entries.end(),
+                     [](const entry& a, const entry& b) {
+                         return a.last_used > b.last_used;
+                     });
+    if (capacity > 0 && _entries.size() > capacity) {
+        _entries.erase(_entries.begin() + capacity, _entries.end());
+    }
+
+    os << '#' << key() << ';' << runs + 1 << '\n';
+    for (const entry& e : _entries) {
+        insert_with_semicolon(os, e.last_used);
+        insert_with_semicolon(os, e.x);
+        insert_with_semicolon(os, e.y);
+        insert_with_semicolon(os, e.probe_x);
+        for (unsigned j = 0; j < c.elements; j++) {
+            for (unsigned k = 0; k < c.elements; k++) {
+                insert_with_semicolon(os, e.tof.at(j, k));
+            }
+        }
+        os << '\n';
+    }
+    os.flush();
+    return (bool)os;
+}
+
+unsigned
+column_cache::lookup(const pricer& price,
+                     double threshold,
+                     std::vector<time_of_flight>& out)
+{
+    const double probe_x = c.probe_x_pos_in_tacts();
+    const unsigned roi_start = c.get_roi_start();
+    const unsigned roi_end = c.get_roi_end();
+
+    std::vector<std::pair<double, time_of_flight>> found;
+    for (entry& e : _entries) {
+        time_of_flight tof(c.elements, c.elements, {});
+        if (std::abs(e.probe_x - probe_x) < 1e-9) {
+            e.tof.copy_to(tof);
+        } else {
+            c.tact_coords_to_tof(e.x - probe_x, e.y, tof);
+        }
+        if (!tof.in_bounds(roi_start, roi_end)) {
+            continue;
+        }
+        const double value = price(tof);
+        if (value > threshold) {
+            e.last_used = runs + 1;
+            found.emplace_back(value, std::move(tof));
+        }
+    }
+
+    std::stable_sort(found.begin(), found.end(), [](auto& a, auto& b) {
+        return a.first > b.first;
+    });
+    for (auto& [value, tof] : found) {
+        out.push_back(std::move(tof));
+    }
+    return found.size();
+}
+
+void
+column_cache::store(const time_of_flight& tof)
+{
+    const double probe_x = c.probe_x_pos_in_tacts();
+    double x, y;
+    estimate_position(c, tof, x, y);
+    x += probe_x;
+
+    for (entry& e : _entries) {
+        if (std::abs(e.x - x) < same_reflector &&
+            std::abs(e.y - y) < same_reflector) {
+            e.last_used = runs + 1;
+            return;
+        }
+    }
+    time_of_flight copy(tof.senders, tof.receivers, tof.representant_x);
+    tof.copy_to(copy);
+    _entries.push_back({ runs + 1, x, y, probe_x, std::move(copy) });
+}
+
+void
+column_cache::estimate_position(const config& c,
+                                const time_of_flight& tof,
+                                double& x,
+                                double& y)
+{
+    assert(c.elements > 1);
+    // the diagonal is floor(2 * distance), and distance^2 - (e * pitch)^2 = -2 * pitch * x * e + x^2 + y^2 is linear
+    // in e : a least squares line through the diagonal gives x from its slope and y from its intercept.
+    const double pitch = c.element_pitch_in_tacts();
+    const double n = c.elements;
+    double sum_e = 0.0, sum_ee = 0.0, sum_b = 0.0, sum_eb = 0.0;
+    for (unsigned e = 0; e < c.elements; e++) {
+        const double distance = (tof.at(e, e) + 0.5) / 2.0;
+        const double b = distance * distance - std::pow(e * pitch, 2);
+        sum_e += e;
+        sum_ee += e * e;
+        sum_b += b;
+        sum_eb += e * b;
+    }
+    const double slope =
+      (n * sum_eb - sum_e * sum_b) / (n * sum_ee - sum_e * sum_e);
+    const double intercept = (sum_b - slope * sum_e) / n;
+    x = -slope / (2.0 * pitch);
+    y = std::sqrt(std::max(intercept - x * x, 0.0));
+}
+
+const std::vector<column_cache::entry>&
+column_cache::entries() const
+{
+    return _entries;
+}
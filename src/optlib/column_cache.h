@@ -0,0 +1,80 @@
+#ifndef COLUMN_CACHE_H
+#define COLUMN_CACHE_H
+
+#include "config.h"
+#include "coordinates.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+///@brief Keeps the columns of finished runs on disk to warm start later runs with the same acquisition geometry.
+///
+/// A cache belongs to one geometry (pitch, elements, wave speed, sampling rate and ROI, see key()), a file written
+/// for another geometry is ignored. Every column is kept with the position of its reflector relative to the specimen
+/// (the probe position added), so that it can be moved under the probe of a later run : when the probe did not move
+/// the original tof is used, otherwise it is recomputed from the reflector position.
+/// Every lookup or store of a column marks it as used in the current run, save keeps the capacity most recently used
+/// columns.
+class column_cache
+{
+  public:
+    column_cache(const config& c, unsigned capacity);
+
+    /// One cached column.
+    struct entry
+    {
+        /// The run that used the column last.
+        unsigned last_used;
+        /// The reflector position in tacts, x relative to the specimen.
+        double x;
+        double y;
+        /// The probe position in tacts of the run that found the column.
+        double probe_x;
+        time_of_flight tof;
+    };
+
+    using pricer = std::function<double(const time_of_flight&)>;
+
+    /// Maximal number of columns written by save.
+    unsigned capacity;
+
+    /// Identifies the geometry, can be used as file name.
+    std::string key() const;
+
+    /// Reads the columns saved for the same key, returns false (and reads nothing) for another key.
+    bool load(std::istream& is);
+    /// Writes the capacity most recently used columns.
+    bool save(std::ostream& os);
+
+    /// @brief Appends the cached columns under the current probe with price(tof) > threshold to out, best first.
+    ///
+    /// Columns leaving the ROI are skipped. Returns the number of appended columns.
+    unsigned lookup(const pricer& price,
+                    double threshold,
+                    std::vector<time_of_flight>& out);
+
+    /// Adds a column found under the current probe, a cached column of the same reflector is only marked as used.
+    void store(const time_of_flight& tof);
+
+    /// Estimates the reflector position (relative to the probe, in tacts) from the diagonal of tof.
+    static void estimate_position(const config& c,
+                                  const time_of_flight& tof,
+                                  double& x,
+                                  double& y);
+
+    const std::vector<entry>& entries() const;
+
+  protected:
+    const config& c;
+    /// Number of runs that saved the cache, the current run is runs + 1.
+    unsigned runs = 0;
+    std::vector<entry> _entries;
+
+    /// Reflectors closer than this (in tacts) are the same.
+    static constexpr double same_reflector = 0.5;
+};
+
+#endif
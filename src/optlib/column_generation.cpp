@@ -80,6 +80,12 @@ column_generation::dump(std::ostream& os,
     c.save(os, { tofs }, { values });
 }
 
+double
+column_generation::lower_bound() const
+{
+    return instance->lower_bound();
+}
+
 void
 column_generation::run(warm_start warm_start,
                        std::vector<time_of_flight>& reflectors_out,
@@ -117,10 +123,27 @@ column_generation::run(warm_start warm_start,
 
     dump_warm_start_solutions();
 
+    iterations = 0;
+    heuristic_iterations = 0;
     for (unsigned iteration = 0; iteration < c.max_columns; iteration++) {
-        print->print_log("(CG) Running Slave, iteration " +
-                         std::to_string(iteration + 1));
-        instance->slave_run(*slave, *conv);
+        iterations++;
+        if (instance->pool_run(*conv)) {
+            print->print_log(
+              "(CG) Reusing " +
+              std::to_string(instance->columns_for_masters_update().size()) +
+              " columns from the column pool, iteration " +
+              std::to_string(iteration + 1));
+        } else if (instance->heuristic_run(*conv)) {
+            heuristic_iterations++;
+            print->print_log(
+              "(CG) Dual-SAFT found " +
+              std::to_string(instance->columns_for_masters_update().size()) +
+              " columns, iteration " + std::to_string(iteration + 1));
+        } else {
+            print->print_log("(CG) Running Slave, iteration " +
+                             std::to_string(iteration + 1));
+            instance->slave_run(*slave, *conv);
+        }
 
         double slave_obj =
           instance->columns_for_masters_update().front().stats.objective;
@@ -137,6 +160,21 @@ column_generation::run(warm_start warm_start,
         }
 
         optimal = slave_obj <= c.slave_threshold;
+        while (optimal && instance->mispriced()) {
+            print->print_log("(CG) Stabilised dual mispriced, running Slave "
+                             "again");
+            instance->slave_run(*slave, *conv);
+            slave_obj =
+              instance->columns_for_masters_update().front().stats.objective;
+            for (const auto& column : instance->columns_for_masters_update()) {
+                slave_obj = std::max(slave_obj, column.stats.objective);
+                print->print_log("(CG) Slave generates (obj:" +
+                                   std::to_string(column.stats.objective) +
+                                   ")",
+                                 column.tof);
+            }
+            optimal = slave_obj <= c.slave_threshold;
+        }
         if (optimal) {
             print->print_log("(CG) Optimal Solution found!");
             break;
@@ -148,6 +186,7 @@ column_generation::run(warm_start warm_start,
         print->print_log("(CG) Master Objective : " +
                          std::to_string(master_obj));
         unsigned variables_cleaned_from_master = master->clean();
+        instance->add_to_pool(master->cleaned);
         if (variables_cleaned_from_master > 0) {
             std::stringstream ss;
             ss << "(MasterCleaning) Removed " << variables_cleaned_from_master
@@ -163,6 +202,16 @@ column_generation::run(warm_start warm_start,
             break;
         }
 
+        const double gap = relative_gap(master_obj, instance->lower_bound());
+        print->print_log("(CG) Lower bound : " +
+                         std::to_string(instance->lower_bound()) +
+                         ", relative gap : " + std::to_string(gap));
+        if (c.relative_gap && gap <= *c.relative_gap) {
+            print->print_log("(CG) Relative gap is under " +
+                             std::to_string(*c.relative_gap));
+            break;
+        }
+
         dump(iteration);
     }
 
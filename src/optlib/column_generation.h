@@ -66,6 +66,13 @@ class column_generation
                      std::vector<time_of_flight>& reflectors_out,
                      std::vector<double>& amplitude_out);
 
+    /// Lower bound for the master objective from the last run.
+    double lower_bound() const;
+    /// Iterations of the last run.
+    unsigned iterations = 0;
+    /// Iterations of the last run whose columns came from the dual-SAFT heuristic.
+    unsigned heuristic_iterations = 0;
+
     void dump_warm_start_solutions() const;
     void dump(std::optional<unsigned> iteration) const;
     void dump(std::ostream& os,
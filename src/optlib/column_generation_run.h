@@ -2,17 +2,24 @@
 #define COLUMN_GENERATION_RUN_H
 
 #include "arr.h"
+#include "column_pool.h"
 #include "config.h"
 #include "constraint_pool.h"
 #include "coordinates.h"
+#include "dual_stabiliser.h"
 #include "fftw_arr.h"
+#include "local_search_slave.h"
 #include "master.h"
+#include "saft.h"
 #include "slave_output_settings.h"
 #include "slave_problem.h"
 #include "stop_watch.h"
+#include <algorithm>
 #include <fstream>
 #include <functional>
 #include <limits>
+#include <memory>
+#include <numeric>
 #include <optional>
 #include <thread>
 
@@ -35,6 +42,23 @@ struct column_generation_run_interface
     /// Add new columns from the slave into the master and run it.
     virtual double master_update_and_run(master_problem& mp) = 0;
 
+    /// Reprices the column pool and moves the columns separating the dual into the masters input. Returns false if a slave is needed.
+    virtual bool pool_run(convolution& conv) = 0;
+
+    /// Prices the tofs of a SAFT grid with the current dual, returns true if some separate the dual (then no slave is needed).
+    virtual bool heuristic_run(convolution& conv) = 0;
+
+    /// Moves the columns removed by the master clean into the column pool.
+    virtual void add_to_pool(std::vector<time_of_flight>& cleaned) = 0;
+
+    /// @brief Called when the slaves found nothing, returns true if a stabilised dual was priced.
+    ///
+    /// The next slave_run then prices the master dual.
+    virtual bool mispriced() = 0;
+
+    /// The best lower bound of the master objective found so far.
+    virtual double lower_bound() const = 0;
+
     virtual const columns& columns_for_masters_update() = 0;
 
     virtual ~column_generation_run_interface(){};
@@ -62,6 +86,36 @@ struct column_generation_run : public column_generation_run_interface
     /// Add new columns from the slave into the master and run it.
     virtual double master_update_and_run(master_problem& mp) override;
 
+    /// Reprices the column pool and moves the columns separating the dual into the masters input. Returns false if a slave is needed.
+    virtual bool pool_run(convolution& conv) override;
+
+    /// @brief Dual-SAFT : every pixel of a SAFT grid is a tof, their reduced costs are looked up in the convolution.
+    ///
+    /// The best pixels are verified with dot_product_with_dual and become the columns for the master.
+    virtual bool heuristic_run(convolution& conv) override;
+
+    /// Moves the columns removed by the master clean into the column pool.
+    virtual void add_to_pool(std::vector<time_of_flight>& cleaned) override;
+
+    virtual bool mispriced() override;
+
+    virtual double lower_bound() const override;
+
+    /// Computes the Lagrangian bound of the pricing dual from the slave bounds of its columns.
+    void update_lower_bound(const columns& priced);
+
+    /// Has to be called after each master run : computes the stabilised dual and invalidates the convolution.
+    void new_dual();
+
+    /// The dual the slaves currently separate (master or stabilised dual).
+    const arr<>& pricing_dual() const;
+
+    /// Computes the trimmed convolution of the dual with the reference, if not already done for the current dual.
+    void convolve_dual(convolution& conv);
+
+    /// The slave objective of tof, looked up in the trimmed convolution (needs convolve_dual).
+    double reduced_cost(const time_of_flight& tof) const;
+
     virtual const columns& columns_for_masters_update() override;
 
     /// Contains the measurement.
@@ -100,6 +154,27 @@ struct column_generation_run : public column_generation_run_interface
     /// The statistics about the current run.
     statistics stats;
 
+    /// Columns removed by the master clean.
+    column_pool cleaned_columns;
+
+    /// The tofs of the dual-SAFT grid, computed on the first heuristic_run.
+    std::vector<time_of_flight> saft_tofs;
+
+    /// True when convoluted belongs to the current dual.
+    bool convolution_current = false;
+
+    /// Computes the stabilised duals.
+    dual_stabiliser stabiliser;
+
+    /// The stabilised dual.
+    ConvolutionArray<double> separation_values;
+
+    /// False when the slaves separate separation_values.
+    bool pricing_master_dual = true;
+
+    /// The best lower bound of the master objective (0 is always valid).
+    double best_lower_bound = 0.0;
+
     /// Contains the time when last master ended.
     stop_watch swe;
 
@@ -121,14 +196,39 @@ struct column_generation_run_async
 {
     using column_generation_run<ConvolutionArray>::column_generation_run;
 
-    /// Checks the dualsolutionpool, executes the convolution and runs the slave.
+    /// @brief Checks the dualsolutionpool, executes the convolution and runs the slave.
+    ///
+    /// With c.pipeline_batch, every dual is convolved and published to the slaves, and the master waits only until
+    /// the pool holds c.pipeline_batch separating columns (or c.pipeline_wait after the first one).
     virtual void slave_run(slave_problem& sp, convolution& conv) override;
 
+    /// Runs the master and passes the columns it uses to the local search.
+    virtual double initial_master_run(
+      master_problem& mp,
+      std::vector<time_of_flight>& warm_start,
+      std::optional<std::reference_wrapper<std::vector<double>>>
+        warm_start_values,
+      bool slowly) override;
+
+    /// Runs the master and passes the columns it uses to the local search.
+    virtual double master_update_and_run(master_problem& mp) override;
+
     /// The current solutions for the master. May contain columns that the master won't see because they may not separate the dual.
     constraint_pool pool;
 
     /// Used to tell the slave when it can print.
     slave_output_settings can_print = { 2000ms };
+
+    /// @brief Searches the neighbourhoods of the master columns in parallel to the slaves and adds to pool, not used when empty.
+    ///
+    /// Started by slave_run with the slaves, so it does not run for a dual that the pool already separates (unless
+    /// pipelined), and cancelled by the next master solve.
+    std::unique_ptr<local_search_slave> local_search;
+
+    /// Busy time of the slaves at the end of the last slave_run, for the per-iteration utilisation.
+    double last_busy_time = 0.0;
+    /// Appends the time the master waited and the time the slaves spent solving since the last call to stats.
+    void record_utilisation(slave_problem& sp, double master_wait);
 };
 
 template<template<typename> class ConvolutionArray>
@@ -146,6 +246,11 @@ column_generation_run<ConvolutionArray>::column_generation_run(
                 measurement.dim2,
                 measurement.dim3 + reference_signal.dim3 - 1)
   , convoluted(measurement.dim1, measurement.dim2, measurement.dim3)
+  , cleaned_columns(c.column_pool_size, c.column_pool_age)
+  , stabiliser((dual_stabiliser::mode)c.stabilisation,
+               c.stabilisation_alpha,
+               c.stabilisation_box)
+  , separation_values(measurement.dim1, measurement.dim2, measurement.dim3)
   , slave_statistics_output(c.output + ".slavestats")
   , master_statistics_output(c.output + ".masterstats")
   , time_output(c.output + ".times")
@@ -176,6 +281,9 @@ column_generation_run<ConvolutionArray>::initial_master_run(
                              master_problem::BARRIER,
                              this->dual,
                              this->master_obj);
+    new_dual();
+    dual.stats.lower_bound = best_lower_bound;
+    dual.stats.gap = relative_gap(master_obj, best_lower_bound);
     stats.master_time.push_back(swe.elapsed(stop_watch::SET_TO_ZERO));
     stats.add_statistic_for_master(dual.stats);
     stats.print_last_iteration(
@@ -189,18 +297,7 @@ column_generation_run<ConvolutionArray>::initial_master_run(
         }
 
     } else {
-        if (warm_start_values) {
-            for (unsigned i = 0; i < warm_start.size(); i++) {
-                mp.add_variable(warm_start[i],
-                                this->reference_signal,
-                                warm_start_values->get()[i]);
-            }
-        } else {
-            for (unsigned i = 0; i < warm_start.size(); i++) {
-                mp.add_variable(
-                  warm_start[i], this->reference_signal, std::nullopt);
-            }
-        }
+        mp.add_variables(warm_start, this->reference_signal, warm_start_values);
 
         if (warm_start.size() > 0) {
             mp.solve_reduced_problem(this->c.elements,
@@ -210,6 +307,7 @@ column_generation_run<ConvolutionArray>::initial_master_run(
                                      master_problem::BARRIER,
                                      this->dual,
                                      this->master_obj);
+            new_dual();
         }
     }
 
@@ -224,11 +322,199 @@ column_generation_run<ConvolutionArray>::slave_run(slave_problem& sp,
 {
     master_input.clear();
 
-    conv.convolve(dual.values, inverted_reference_signal, _convoluted);
+    convolve_dual(conv);
+    sp.run(convoluted, master_input);
+    update_lower_bound(master_input);
+}
+
+template<template<typename> class ConvolutionArray>
+void
+column_generation_run<ConvolutionArray>::convolve_dual(convolution& conv)
+{
+    if (convolution_current) {
+        return;
+    }
+    if (pricing_master_dual) {
+        conv.convolve(dual.values, inverted_reference_signal, _convoluted);
+    } else {
+        conv.convolve(
+          separation_values, inverted_reference_signal, _convoluted);
+    }
     assert(reference_signal.dim3 < measurement.dim3);
     // remove things interfering before the measurement, because they have negative coordinates
     _convoluted.sub_to(convoluted, 0, 0, reference_signal.dim3 - 1);
-    sp.run(convoluted, master_input);
+    convolution_current = true;
+}
+
+template<template<typename> class ConvolutionArray>
+double
+column_generation_run<ConvolutionArray>::reduced_cost(
+  const time_of_flight& tof) const
+{
+    assert(convolution_current && "Convolution belongs to an old dual!");
+    const int offset = c.get_roi_start();
+    double cost = 0.0;
+    for (unsigned i = 0; i < tof.senders; i++) {
+        for (unsigned j = 0; j < tof.receivers; j++) {
+            // convoluted(i, j, p) is the dot product of the dual with the reference shifted by p.
+            const int p = (int)tof.at(i, j) - offset;
+            if (p >= (int)convoluted.dim3) {
+                continue;
+            }
+            if (p >= 0) {
+                cost += convoluted.at(i, j, p);
+                continue;
+            }
+            // starts before the measurement, was trimmed from convoluted.
+            for (int s = -p; s < (int)reference_signal.dim3 &&
+                             p + s < (int)pricing_dual().dim3;
+                 s++) {
+                cost += reference_signal.at(i, j, s) *
+                        pricing_dual().at(i, j, p + s);
+            }
+        }
+    }
+    return cost;
+}
+
+template<template<typename> class ConvolutionArray>
+bool
+column_generation_run<ConvolutionArray>::pool_run(convolution& conv)
+{
+    if (cleaned_columns.empty()) {
+        return false;
+    }
+    master_input.clear();
+    convolve_dual(conv);
+    return cleaned_columns.reprice(
+             [&](const time_of_flight& tof) { return reduced_cost(tof); },
+             c.slave_threshold,
+             master_input) > 0;
+}
+
+template<template<typename> class ConvolutionArray>
+bool
+column_generation_run<ConvolutionArray>::heuristic_run(convolution& conv)
+{
+    if (c.dual_saft_resolution == 0) {
+        return false;
+    }
+    if (saft_tofs.empty()) {
+        saft(c.dual_saft_resolution, 2 * c.dual_saft_resolution, c)
+          .grid_tofs(saft_tofs);
+    }
+    master_input.clear();
+    convolve_dual(conv);
+
+    std::vector<std::pair<double, unsigned>> costs;
+    for (unsigned t = 0; t < saft_tofs.size(); t++) {
+        const double cost = reduced_cost(saft_tofs[t]);
+        if (cost > c.slave_threshold) {
+            costs.emplace_back(cost, t);
+        }
+    }
+    const unsigned candidates =
+      std::min<unsigned>(c.dual_saft_columns, costs.size());
+    std::partial_sort(costs.begin(),
+                      costs.begin() + candidates,
+                      costs.end(),
+                      std::greater<std::pair<double, unsigned>>());
+
+    const int offset = c.get_roi_start();
+    for (unsigned candidate = 0; candidate < candidates; candidate++) {
+        const time_of_flight& tof = saft_tofs[costs[candidate].second];
+        const double exact =
+          tof.dot_product_with_dual(reference_signal, pricing_dual(), offset);
+        if (exact <= c.slave_threshold) {
+            continue;
+        }
+        time_of_flight copy(tof.senders, tof.receivers, tof.representant_x);
+        tof.copy_to(copy);
+        // a heuristic does not bound the slave objective.
+        master_input.emplace_back(
+          std::move(copy),
+          slave_statistics{ exact,
+                            0,
+                            exact,
+                            std::numeric_limits<double>::infinity(),
+                            0,
+                            0 });
+    }
+    return !master_input.empty();
+}
+
+template<template<typename> class ConvolutionArray>
+void
+column_generation_run<ConvolutionArray>::new_dual()
+{
+    convolution_current = false;
+    pricing_master_dual =
+      !stabiliser.active() ||
+      !stabiliser.separation_point(dual.values, separation_values);
+}
+
+template<template<typename> class ConvolutionArray>
+const arr<>&
+column_generation_run<ConvolutionArray>::pricing_dual() const
+{
+    if (pricing_master_dual) {
+        return dual.values;
+    }
+    return separation_values;
+}
+
+template<template<typename> class ConvolutionArray>
+bool
+column_generation_run<ConvolutionArray>::mispriced()
+{
+    if (pricing_master_dual) {
+        return false;
+    }
+    pricing_master_dual =
+      !stabiliser.mispriced(separation_values, dual.values, measurement);
+    convolution_current = false;
+    return true;
+}
+
+template<template<typename> class ConvolutionArray>
+double
+column_generation_run<ConvolutionArray>::lower_bound() const
+{
+    return best_lower_bound;
+}
+
+template<template<typename> class ConvolutionArray>
+void
+column_generation_run<ConvolutionArray>::update_lower_bound(
+  const columns& priced)
+{
+    if (priced.empty()) {
+        return;
+    }
+    // upper bound for the reduced cost of all columns.
+    double slave_bound = -std::numeric_limits<double>::infinity();
+    for (const column& current : priced) {
+        slave_bound = std::max(slave_bound, current.stats.best_objective_bound);
+    }
+
+    // for y in [-1, 1] and x >= 0 : |m - Ax|_1 >= y^T (m - Ax) >= m^T y - sum(x) * slave_bound.
+    const arr<>& y = pricing_dual();
+    const double dual_objective = std::inner_product(
+      y.data, y.data + y.size(), measurement.data, 0.0);
+    if (slave_bound <= 0.0) {
+        best_lower_bound = std::max(best_lower_bound, dual_objective);
+    } else if (c.amplitude_bound) {
+        best_lower_bound = std::max(
+          best_lower_bound, dual_objective - *c.amplitude_bound * slave_bound);
+    }
+}
+
+template<template<typename> class ConvolutionArray>
+void
+column_generation_run<ConvolutionArray>::add_to_pool(
+  std::vector<time_of_flight>& cleaned)
+{
+    cleaned_columns.add(cleaned);
 }
 
 template<template<typename> class ConvolutionArray>
@@ -240,27 +526,28 @@ column_generation_run_async<ConvolutionArray>::slave_run(slave_problem& sp,
 
     //TODO: tweak this epsylon!
     const double epsylon = 0.1;
-    auto dual_separation_checker = [&](column_with_origin& c) {
+    // the same dual as the slaves get from convolve_dual.
+    auto reduced_cost = [&](column_with_origin& c) {
         return c.c.tof.dot_product_with_dual(this->reference_signal,
-                                             this->dual.values,
-                                             this->c.get_roi_start()) > epsylon;
+                                             this->pricing_dual(),
+                                             this->c.get_roi_start());
     };
 
+    const bool pipelined = this->c.pipeline_batch > 0;
     bool found =
-      pool.consume_non_blocking(this->master_input, dual_separation_checker);
+      pool.consume_non_blocking(this->master_input, reduced_cost, epsylon);
 
-    if (found) {
+    if (found && !pipelined) {
+        record_utilisation(sp, 0.0);
         return;
     }
-    assert(this->master_input.empty());
 
-    conv.convolve(
-      this->dual.values, this->inverted_reference_signal, this->_convoluted);
-    assert(this->reference_signal.dim3 < this->measurement.dim3);
-    // remove things interfering before the measurement, because they have negative coordinates
-    this->_convoluted.sub_to(
-      this->convoluted, 0, 0, this->reference_signal.dim3 - 1);
+    this->convolve_dual(conv);
 
+    if (local_search) {
+        local_search->run_async(this->convoluted);
+    }
+    // pipelined, the slaves get the dual even when the pool already separates it.
     sp.run(this->convoluted, this->master_input);
 
     /// Allow printing.
@@ -272,7 +559,18 @@ column_generation_run_async<ConvolutionArray>::slave_run(slave_problem& sp,
     sp.print(true);
 
     //Make the master wait until there is a solution for him.
-    pool.consume(this->master_input, dual_separation_checker);
+    stop_watch wait;
+    if (pipelined) {
+        pool.consume_batch(
+          this->master_input,
+          reduced_cost,
+          epsylon,
+          this->c.pipeline_batch,
+          std::chrono::duration<double>(this->c.pipeline_wait));
+    } else {
+        pool.consume(this->master_input, reduced_cost, epsylon);
+    }
+    record_utilisation(sp, wait.elapsed());
 
     /// Stop printing.
     {
@@ -281,16 +579,60 @@ column_generation_run_async<ConvolutionArray>::slave_run(slave_problem& sp,
     }
 }
 
+template<template<typename> class ConvolutionArray>
+void
+column_generation_run_async<ConvolutionArray>::record_utilisation(
+  slave_problem& sp,
+  double master_wait)
+{
+    const double busy_time = sp.busy_time();
+    this->stats.master_wait_time.push_back(master_wait);
+    this->stats.slave_busy_time.push_back(busy_time - last_busy_time);
+    last_busy_time = busy_time;
+}
+
+template<template<typename> class ConvolutionArray>
+double
+column_generation_run_async<ConvolutionArray>::initial_master_run(
+  master_problem& mp,
+  std::vector<time_of_flight>& warm_start,
+  std::optional<std::reference_wrapper<std::vector<double>>> warm_start_values,
+  bool slowly)
+{
+    const double obj = column_generation_run<ConvolutionArray>::initial_master_run(
+      mp, warm_start, warm_start_values, slowly);
+    if (local_search) {
+        local_search->set_centres(mp.name2tof, mp.name2amplitude);
+    }
+    return obj;
+}
+
+template<template<typename> class ConvolutionArray>
+double
+column_generation_run_async<ConvolutionArray>::master_update_and_run(
+  master_problem& mp)
+{
+    const double obj =
+      column_generation_run<ConvolutionArray>::master_update_and_run(mp);
+    if (local_search) {
+        local_search->set_centres(mp.name2tof, mp.name2amplitude);
+    }
+    return obj;
+}
+
 template<template<typename> class ConvolutionArray>
 double
 column_generation_run<ConvolutionArray>::master_update_and_run(
   master_problem& mp)
 {
+    std::vector<time_of_flight> variables;
+    variables.reserve(master_input.size());
     for (auto& variable : master_input) {
-        mp.add_variable(variable.tof, reference_signal, std::nullopt);
+        variables.push_back(std::move(variable.tof));
         stats.add_statistic_for_next_master(variable.stats);
     }
     master_input.clear();
+    mp.add_variables(variables, reference_signal, std::nullopt);
 
     stats.slave_time.push_back(swe.elapsed(stop_watch::SET_TO_ZERO));
 
@@ -301,6 +643,9 @@ column_generation_run<ConvolutionArray>::master_update_and_run(
                              {},
                              dual,
                              master_obj);
+    new_dual();
+    dual.stats.lower_bound = best_lower_bound;
+    dual.stats.gap = relative_gap(master_obj, best_lower_bound);
 
     double master_time = swe.elapsed(stop_watch::SET_TO_ZERO);
     stats.add_statistic_for_master(dual.stats);
@@ -0,0 +1,32 @@
+#include "column_pool.h"
+
+column_pool::column_pool(unsigned capacity, unsigned max_age)
+  : capacity(capacity)
+  , max_age(max_age)
+{}
+
+void
+column_pool::add(std::vector<time_of_flight>& tofs)
+{
+    if (capacity > 0) {
+        for (time_of_flight& tof : tofs) {
+            entries.push_back({ std::move(tof), 0 });
+        }
+        while (entries.size() > capacity) {
+            entries.pop_front();
+        }
+    }
+    tofs.clear();
+}
+
+bool
+column_pool::empty() const
+{
+    return entries.empty();
+}
+
+unsigned
+column_pool::size() const
+{
+    return entries.size();
+}
@@ -0,0 +1,68 @@
+#ifndef COLUMN_POOL_H
+#define COLUMN_POOL_H
+
+#include "coordinates.h"
+#include <list>
+#include <vector>
+
+///@brief Keeps the columns removed by the master clean for some iterations.
+///
+/// Removed columns are often needed again a few iterations later, repricing them against the new dual is much cheaper than
+/// finding them again with a slave.
+/// The pool is bounded by capacity (the oldest columns are dropped first) and by max_age (number of reprices a column survives).
+struct column_pool
+{
+    /// A capacity of 0 disables the pool.
+    column_pool(unsigned capacity, unsigned max_age);
+
+    column_pool(column_pool&) = delete;
+
+    struct entry
+    {
+        time_of_flight tof;
+        /// Number of reprices since the column was added.
+        unsigned age;
+    };
+
+    /// Ordered from old to new.
+    std::list<entry> entries;
+
+    unsigned capacity;
+    unsigned max_age;
+
+    /// Moves the tofs into the pool (and clears tofs), drops the oldest entries if the pool is full.
+    void add(std::vector<time_of_flight>& tofs);
+
+    bool empty() const;
+    unsigned size() const;
+
+    /// @brief Moves every column whose reduced_cost is bigger than threshold into out, returns the number of moved columns.
+    ///
+    /// All other columns become older, columns older than max_age are dropped.
+    template<typename ReducedCost>
+    unsigned reprice(ReducedCost reduced_cost, double threshold, columns& out);
+};
+
+template<typename ReducedCost>
+unsigned
+column_pool::reprice(ReducedCost reduced_cost, double threshold, columns& out)
+{
+    unsigned found = 0;
+    auto current = entries.begin();
+    while (current != entries.end()) {
+        const double cost = reduced_cost(current->tof);
+        if (cost > threshold) {
+            out.emplace_back(std::move(current->tof),
+                             slave_statistics{ cost, 0, cost, cost, 0, 0 });
+            current = entries.erase(current);
+            found++;
+        } else if (++current->age > max_age) {
+            current = entries.erase(current);
+        } else {
+            current++;
+        }
+    }
+    return found;
+}
+
+#endif
@@ -416,6 +416,27 @@ config::consistency_check() const
     assert_that(slavestop >= slave_threshold,
                 "Incompatible slavestop and slave_threshold! Why should the "
                 "slave stop at a slavestop < slave_threshold?");
+    assert_that(stabilisation <= 3, "Unknown stabilisation mode!");
+    assert_that(stabilisation_alpha >= 0.0 && stabilisation_alpha < 1.0,
+                "The stabilisation_alpha has to be in [0, 1)!");
+    assert_that(stabilisation_box > 0.0,
+                "The stabilisation_box has to be positive!");
+    assert_that(!relative_gap || *relative_gap >= 0.0,
+                "The relative_gap cannot be negative!");
+    assert_that(!amplitude_bound || *amplitude_bound >= 0.0,
+                "The amplitude_bound cannot be negative!");
+    assert_that(!relative_gap || amplitude_bound,
+                "The relative_gap needs an amplitude_bound, without it the "
+                "lower bound only moves when the slaves prove optimality!");
+    assert_that(!geometric_slave || !diagonal_slave,
+                "Choose either the geometric_slave or the diagonal_slave!");
+    assert_that(!(geometric_slave || diagonal_slave) ||
+                  (!slave_portfolio && !strip_overlap),
+                "The geometric_slave and the diagonal_slave run alone, they "
+                "cannot be used with the slave_portfolio or the strip_overlap "
+                "of the Gurobi slaves!");
+    assert_that(!lazy_rows || *lazy_rows >= 0.0,
+                "The lazy_rows threshold cannot be negative!");
 }
 
 void
@@ -117,6 +117,10 @@ class config
     double slavestop = 1e6;
     unsigned offset = 0;
     unsigned master_solver = 0;
+    /// Let the master choose the fastest solver method per iteration (only for the Gurobi master).
+    bool adaptive_master_solver = false;
+    /// The adaptive master tries another method every adaptive_exploration solves (0 : never).
+    unsigned adaptive_exploration = 5;
 
     std::optional<unsigned> roi_start;
     std::optional<unsigned> roi_end;
@@ -132,6 +136,70 @@ class config
     /// Remove solutions from the master that are below threshold.
     std::optional<double> master_solution_threshold;
 
+    /// Use simplex_master instead of grb_master.
+    bool in_house_master = false;
+
+    /// Build the slack variables of grb_master without names (faster start).
+    bool no_master_names = false;
+    /// Rows of the Gurobi master with |measurement| <= lazy_rows are only added when a column needs them.
+    std::optional<double> lazy_rows;
+
+    /// Fix slave binaries that can not be part of an optimal column before solving, see grb_slave::presolve.
+    bool slave_presolve = false;
+    /// Price with the branch-and-bound over reflector positions of geometric_slave instead of the Gurobi slaves, in a threaded_slave for the async run.
+    bool geometric_slave = false;
+    /// Price with the compact grb_diagonal_slave (binaries on the diagonal only) in a threaded_slave, the full slave is only solved when it finds nothing.
+    bool diagonal_slave = false;
+    /// Let a slave_portfolio choose the cuts, callback options, seed and gap of the async slaves.
+    bool slave_portfolio = false;
+    /// Gives every async slave its own strip of the horizontal ROI, overlapping by strip_overlap (unset disables the decomposition).
+    std::optional<double> strip_overlap;
+    /// Maximal number of columns kept in the constraint pool of the async slaves, 0 for no limit.
+    unsigned pool_capacity = 0;
+    /// Pipelined async loop : the master re-solves as soon as the pool holds pipeline_batch separating columns and every dual is published to the slaves, 0 disables it.
+    unsigned pipeline_batch = 0;
+    /// Seconds the pipelined master waits for pipeline_batch columns once it has one.
+    double pipeline_wait = 0.05;
+    /// Running slaves are restarted on the newest dual when their dual is pipeline_dual_age or more duals old.
+    unsigned pipeline_dual_age = 1;
+    /// Directory of the column_cache used to warm start the master and filled after the run, empty disables it.
+    std::string column_cache_directory;
+    /// Maximal number of columns kept per geometry in the column cache, 0 for no limit.
+    unsigned column_cache_size = 1000;
+    /// Neighbourhood radius of the local search around the master columns that runs next to the async slaves, 0 disables it.
+    unsigned local_search_radius = 0;
+    /// Maximal number of moves of the local search per master column.
+    unsigned local_search_steps = 10;
+
+    /// Maximal number of columns removed by the master clean that are kept for repricing, 0 disables the column pool.
+    unsigned column_pool_size = 0;
+    /// Number of iterations a removed column stays in the column pool.
+    unsigned column_pool_age = 10;
+
+    /// Width of the dual-SAFT grid priced before the slaves (its height is twice the width), 0 disables the heuristic.
+    unsigned dual_saft_resolution = 0;
+    /// Maximal number of columns the dual-SAFT heuristic returns per iteration.
+    unsigned dual_saft_columns = 5;
+
+    /// Dual stabilisation mode, see dual_stabiliser::mode (0 disables it).
+    unsigned stabilisation = 0;
+    /// Weight of the stability centre for Wentges and in-out stabilisation.
+    double stabilisation_alpha = 0.5;
+    /// Half width of the box around the stability centre for box-step stabilisation.
+    double stabilisation_box = 0.1;
+
+    /// Stop when the relative gap between master objective and lower bound is below this value, needs amplitude_bound.
+    std::optional<double> relative_gap;
+    /// @brief Upper bound for the sum of the amplitudes of an optimal master solution.
+    ///
+    /// Needed for the Lagrangian bound when the slaves still find separating columns, without it only duals proven feasible by the slaves give bounds.
+    std::optional<double> amplitude_bound;
+
+    /// Use the matrix-free pdhg_master instead of an exact master.
+    bool pdhg_master = false;
+    /// Let the exact master (in_house_master decides which one) polish the solution of the pdhg_master.
+    bool pdhg_polish = false;
+
     double wave_frequency() const;
 
     unsigned get_roi_start() const;
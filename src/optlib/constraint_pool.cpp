@@ -1,23 +1,110 @@
-
 #include "constraint_pool.h"
 
 constraint_pool::constraint_pool() {}
 
 void
-constraint_pool::add(column&& c, unsigned slave_id)
+constraint_pool::push(column_with_origin&& c)
 {
-    std::unique_lock l{ pool_mutex };
-    pool.push_back({ std::move(c), slave_id });
+    ingest.push(std::move(c));
     actual_unconsumed++;
 
-    // notify one because there is only one master/consument
-    pool_not_empty.notify_one();
+    // the lock only orders the notification with a master that is about to sleep.
+    if (waiting) {
+        std::unique_lock l{ wait_mutex };
+        pool_not_empty.notify_one();
+    }
+}
+
+void
+constraint_pool::add(column&& c, unsigned slave_id)
+{
+    push({ std::move(c), slave_id });
+}
+
+void
+constraint_pool::add_to_current(column&& c)
+{
+    push({ std::move(c), slave_id });
+}
+
+std::size_t
+constraint_pool::hash(const time_of_flight& tof)
+{
+    // FNV-1a over the entries.
+    std::size_t h = 14695981039346656037ull;
+    for (unsigned value : tof) {
+        h ^= value;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+void
+constraint_pool::drain()
+{
+    ingest.pop_all([&](column_with_origin&& c) {
+        const std::size_t h = hash(c.c.tof);
+        auto range = pending_index.equal_range(h);
+        for (auto index = range.first; index != range.second; ++index) {
+            column_with_origin& existing = *index->second;
+            if (std::equal(existing.c.tof.begin(),
+                           existing.c.tof.end(),
+                           c.c.tof.begin(),
+                           c.c.tof.end())) {
+                // keep the most optimal flag, optimal columns prove the end of the column generation.
+                existing.c.optimality =
+                  std::min(existing.c.optimality, c.c.optimality);
+                existing.slave_id = std::max(existing.slave_id, c.slave_id);
+                duplicates++;
+                actual_unconsumed--;
+                return;
+            }
+        }
+        pending.push_back(std::move(c));
+        pending_index.emplace(h, std::prev(pending.end()));
+    });
+}
+
+void
+constraint_pool::evict()
+{
+    if (capacity == 0 || pending.size() <= capacity) {
+        return;
+    }
+    std::vector<std::list<column_with_origin>::iterator> candidates;
+    for (auto it = pending.begin(); it != pending.end(); ++it) {
+        if (it->c.optimality == column::NON_OPTIMAL) {
+            candidates.push_back(it);
+        }
+    }
+    const unsigned count =
+      std::min<unsigned>(pending.size() - capacity, candidates.size());
+    std::partial_sort(
+      candidates.begin(),
+      candidates.begin() + count,
+      candidates.end(),
+      [](const auto& a, const auto& b) {
+          return std::make_pair(a->slave_id, a->last_cost) <
+                 std::make_pair(b->slave_id, b->last_cost);
+      });
+    for (unsigned e = 0; e < count; e++) {
+        auto it = candidates[e];
+        auto range = pending_index.equal_range(hash(it->c.tof));
+        for (auto index = range.first; index != range.second; ++index) {
+            if (index->second == it) {
+                pending_index.erase(index);
+                break;
+            }
+        }
+        pending.erase(it);
+        actual_unconsumed--;
+        evictions++;
+    }
 }
 
 void
 constraint_pool::set_current_slave_id(unsigned slave_id)
 {
-    std::unique_lock l{ pool_mutex };
     this->slave_id = slave_id;
 }
 
@@ -26,8 +113,21 @@ constraint_pool::get_statistics(unsigned& total_consumed,
                                 unsigned& consumed_from_old_slave,
                                 unsigned& actual_unconsumed)
 {
-    std::unique_lock l{ pool_mutex };
     total_consumed = this->total_consumed;
     consumed_from_old_slave = this->consumed_from_old_slave;
     actual_unconsumed = this->actual_unconsumed;
 }
+
+unsigned
+constraint_pool::duplicate_count() const
+{
+    return duplicates;
+}
+
+void
+constraint_pool::get_eviction_statistics(unsigned& evictions,
+                                         unsigned& hits) const
+{
+    evictions = this->evictions;
+    hits = this->hits;
+}
@@ -2,9 +2,17 @@
 #define CONSTRAINT_POOL_H
 
 #include "coordinates.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <iterator>
+#include <limits>
 #include <list>
 #include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 /// Removes entries from a list that matches a predicate.
 template<typename Predicate, typename List>
@@ -39,36 +47,126 @@ struct list_predicate_checker
     }
 };
 
+///@brief Lock-free multiple-producer single-consumer queue.
+///
+/// Producers push with a single compare-and-swap on the head of a linked stack, the consumer takes all nodes at once
+/// with one exchange and reverses them into arrival order.
+template<typename T>
+class mpsc_queue
+{
+    struct node
+    {
+        T value;
+        node* next;
+    };
+    std::atomic<node*> head{ nullptr };
+
+  public:
+    mpsc_queue() = default;
+    mpsc_queue(const mpsc_queue&) = delete;
+    ~mpsc_queue()
+    {
+        pop_all([](T&&) {});
+    }
+
+    /// Never blocks, can be called from any thread.
+    void push(T&& value)
+    {
+        node* n = new node{ std::move(value), head.load() };
+        while (!head.compare_exchange_weak(n->next, n)) {
+        }
+    }
+
+    bool empty() const { return head.load() == nullptr; }
+
+    /// Calls f for every pushed value, oldest first. Only for the consumer.
+    template<typename F>
+    void pop_all(F f)
+    {
+        node* n = head.exchange(nullptr);
+        node* reversed = nullptr;
+        while (n) {
+            node* next = n->next;
+            n->next = reversed;
+            reversed = n;
+            n = next;
+        }
+        while (reversed) {
+            node* next = reversed->next;
+            f(std::move(reversed->value));
+            delete reversed;
+            reversed = next;
+        }
+    }
+};
+
 /// Used for old-slaves statistics. Contains a columns and the id of the slave that generated it.
 struct column_with_origin
 {
     column c;
     unsigned slave_id;
+    /// Reduced cost at the last consume, infinity before the first one.
+    double last_cost = std::numeric_limits<double>::infinity();
+    /// Number of consumes that scored this column.
+    unsigned scans = 0;
 };
 
-/// Passes the slave results to the master for concurrent slave/master accesses.
+///@brief Passes the slave results to the master for concurrent slave/master accesses.
+///
+/// The slaves push into a lock-free queue and never wait for the master. The master moves the queue into its pending
+/// columns when consuming, where a tof that is already pending is merged instead of added twice (found via its hash).
+/// The pending columns are rescored with the current dual on every consume and returned best first.
 struct constraint_pool
 {
   protected:
-    /// Contains the results + objective from all the slaves.
-    std::list<column_with_origin> pool;
+    /// Filled by the slaves.
+    mpsc_queue<column_with_origin> ingest;
 
-    /// Exclusive access to add or to consume solutions
-    std::mutex pool_mutex;
+    /// Columns that were not consumed yet, only accessed by the master.
+    std::list<column_with_origin> pending;
+    /// Hashes of the pending tofs.
+    std::unordered_multimap<std::size_t, std::list<column_with_origin>::iterator>
+      pending_index;
 
+    /// Only held by a master waiting for columns (and by slaves waking it up).
+    std::mutex wait_mutex;
     /// Notify when there is a solution, needed for the start or when master is too fast for the slaves.
     std::condition_variable pool_not_empty;
+    /// True while the master waits for columns.
+    std::atomic<bool> waiting{ false };
 
-    unsigned slave_id = 0;
+    std::atomic<unsigned> slave_id{ 0 };
     unsigned total_consumed = 0;
-    unsigned actual_unconsumed = 0;
+    std::atomic<unsigned> actual_unconsumed{ 0 };
     unsigned consumed_from_old_slave = 0;
+    unsigned duplicates = 0;
+    unsigned evictions = 0;
+    unsigned hits = 0;
+
+    /// Pushes into the ingest queue and wakes up a waiting master.
+    void push(column_with_origin&& c);
+
+    /// Moves the ingest queue into pending, merges duplicates.
+    void drain();
+
+    /// Moves the pending columns with reduced_cost > threshold (and the optimal ones) into out, best first.
+    template<typename Cost>
+    bool take(columns& out, Cost reduced_cost, double threshold);
+
+    /// Removes pending columns until at most capacity remain, oldest slave_id first and the worst last_cost among them.
+    void evict();
 
   public:
     constraint_pool();
 
     constraint_pool(constraint_pool&) = delete;
 
+    /// Maximal number of pending columns kept after a consume, 0 for no limit. Optimal columns are never evicted.
+    unsigned capacity = 0;
+
+    /// Maximal number of columns returned by one consume, 0 for no limit.
+    unsigned max_consumed = 0;
+
     /// Set the current slave_id (only needed for statistic purposes).
     void set_current_slave_id(unsigned slave_id);
 
@@ -77,69 +175,184 @@ struct constraint_pool
                         unsigned& consumed_from_old_slave,
                         unsigned& actual_unconsumed);
 
-    /// Move one time-of-flight to the pool, does all the locking.
+    /// Number of columns that were merged into an already pending column with the same tof.
+    unsigned duplicate_count() const;
+
+    /// Number of evicted columns and of columns consumed after they failed at least one earlier consume (hits).
+    void get_eviction_statistics(unsigned& evictions, unsigned& hits) const;
+
+    /// Move one time-of-flight to the pool, never blocks.
     void add(column&& c, unsigned slave_id);
 
-    /// Moves all time of flights of the pool into out that satisfies the given predicate. Blocks if blocking is true.
-    template<typename Predicate>
-    bool consume(columns& out, Predicate p, bool blocking);
+    /// Move one time-of-flight found for the dual of the current slave to the pool.
+    void add_to_current(column&& c);
 
-    /// Moves all time of flights of the pool into out that satisfies the given predicate. Blocks if none is found.
-    template<typename Predicate>
-    void consume(columns& out, Predicate p);
+    /// Hash of the entries of a tof.
+    static std::size_t hash(const time_of_flight& tof);
 
-    /// Moves all time of flights of the pool into out that satisfies the given predicate. Returns false if none is found.
-    template<typename Predicate>
-    bool consume_non_blocking(columns& out, Predicate p);
-};
+    /// @brief Moves all columns of the pool with reduced_cost > threshold into out, best first. Blocks if blocking is true.
+    ///
+    /// reduced_cost may also be a predicate, true counts as 1 and false as 0 then.
+    template<typename Cost>
+    bool consume(columns& out,
+                 Cost reduced_cost,
+                 bool blocking,
+                 double threshold = 0.0);
 
-template<typename Predicate>
-void
-constraint_pool::consume(columns& columns, Predicate p)
-{
-    consume(columns, p, true);
-}
+    /// Moves all columns of the pool with reduced_cost > threshold into out. Blocks if none is found.
+    template<typename Cost>
+    void consume(columns& out, Cost reduced_cost, double threshold = 0.0);
+
+    /// Moves all columns of the pool with reduced_cost > threshold into out. Returns false if none is found.
+    template<typename Cost>
+    bool consume_non_blocking(columns& out,
+                              Cost reduced_cost,
+                              double threshold = 0.0);
+
+    /// @brief Moves columns with reduced_cost > threshold into out until it holds batch of them (or an optimal one).
+    ///
+    /// Blocks while out is empty, but waits at most batch_wait for more columns once it holds one. Columns already in
+    /// out count for the batch.
+    template<typename Cost>
+    void consume_batch(columns& out,
+                       Cost reduced_cost,
+                       double threshold,
+                       unsigned batch,
+                       std::chrono::duration<double> batch_wait);
+};
 
-template<typename Predicate>
+template<typename Cost>
 bool
-constraint_pool::consume(columns& columns, Predicate p, bool blocking)
+constraint_pool::take(columns& out, Cost reduced_cost, double threshold)
 {
-    std::unique_lock l{ pool_mutex };
+    using entry = std::pair<double, std::list<column_with_origin>::iterator>;
+    std::vector<entry> heap;
+    for (auto it = pending.begin(); it != pending.end(); ++it) {
+        const double cost = reduced_cost(*it);
+        it->last_cost = cost;
+        it->scans++;
+        if (it->c.optimality != column::NON_OPTIMAL) {
+            heap.emplace_back(std::numeric_limits<double>::infinity(), it);
+        } else if (cost > threshold) {
+            heap.emplace_back(cost, it);
+        }
+    }
+    auto smaller_cost = [](const entry& a, const entry& b) {
+        return a.first < b.first;
+    };
+    std::make_heap(heap.begin(), heap.end(), smaller_cost);
 
-    list_predicate_checker checker(pool, [&](column_with_origin& c) {
-        bool ret = p(c) || c.c.optimality != column::NON_OPTIMAL;
-        if (ret) {
-            columns.push_back(std::move(c.c));
+    const unsigned count = max_consumed == 0
+                             ? heap.size()
+                             : std::min<unsigned>(max_consumed, heap.size());
+    for (unsigned taken = 0; taken < count; taken++) {
+        std::pop_heap(heap.begin(), heap.end(), smaller_cost);
+        auto it = heap.back().second;
+        heap.pop_back();
 
-            // statistics
-            total_consumed++;
-            if (c.slave_id < slave_id) {
-                consumed_from_old_slave++;
+        auto range = pending_index.equal_range(hash(it->c.tof));
+        for (auto index = range.first; index != range.second; ++index) {
+            if (index->second == it) {
+                pending_index.erase(index);
+                break;
             }
-            actual_unconsumed--;
+        }
+
+        out.push_back(std::move(it->c));
+
+        // statistics
+        total_consumed++;
+        if (it->slave_id < slave_id) {
+            consumed_from_old_slave++;
+        }
+        actual_unconsumed--;
+        if (it->scans > 1) {
+            hits++;
+        }
+
+        out.back().stats.used_old_slave_solutions = consumed_from_old_slave;
+        out.back().stats.total_old_slave_solutions = total_consumed;
+        out.back().stats.solutions_in_pool = actual_unconsumed;
+        out.back().stats.actual_slave_id = it->slave_id;
+        out.back().stats.pool_evictions = evictions;
+        out.back().stats.pool_hits = hits;
+
+        pending.erase(it);
+    }
+    evict();
+    return count > 0;
+}
 
-            columns.back().stats.used_old_slave_solutions =
-              consumed_from_old_slave;
-            columns.back().stats.total_old_slave_solutions = total_consumed;
-            columns.back().stats.solutions_in_pool = actual_unconsumed;
-            columns.back().stats.actual_slave_id = c.slave_id;
+template<typename Cost>
+void
+constraint_pool::consume(columns& columns, Cost reduced_cost, double threshold)
+{
+    consume(columns, reduced_cost, true, threshold);
+}
+
+template<typename Cost>
+bool
+constraint_pool::consume(columns& columns,
+                         Cost reduced_cost,
+                         bool blocking,
+                         double threshold)
+{
+    drain();
+    bool found = take(columns, reduced_cost, threshold);
+    while (blocking && !found) {
+        {
+            std::unique_lock l{ wait_mutex };
+            // set before checking the queue, a slave pushing afterwards sees it and notifies.
+            waiting = true;
+            pool_not_empty.wait(l, [&]() { return !ingest.empty(); });
+            waiting = false;
         }
-        return ret;
-    });
-
-    if (blocking) {
-        pool_not_empty.wait(l, checker);
-        return true;
-    } else {
-        return checker.check();
+        drain();
+        found = take(columns, reduced_cost, threshold);
     }
+    return found;
 }
 
-template<typename Predicate>
+template<typename Cost>
 bool
-constraint_pool::consume_non_blocking(columns& columns, Predicate p)
+constraint_pool::consume_non_blocking(columns& columns,
+                                      Cost reduced_cost,
+                                      double threshold)
 {
-    return consume(columns, p, false);
+    return consume(columns, reduced_cost, false, threshold);
+}
+
+template<typename Cost>
+void
+constraint_pool::consume_batch(columns& columns,
+                               Cost reduced_cost,
+                               double threshold,
+                               unsigned batch,
+                               std::chrono::duration<double> batch_wait)
+{
+    auto complete = [&]() {
+        return columns.size() >= batch ||
+               std::any_of(columns.begin(), columns.end(), [](column& c) {
+                   return c.optimality != column::NON_OPTIMAL;
+               });
+    };
+    // columns taken before (for the same dual) count for the batch.
+    consume(columns, reduced_cost, columns.empty(), threshold);
+    const auto deadline = std::chrono::steady_clock::now() + batch_wait;
+    while (!complete()) {
+        {
+            std::unique_lock l{ wait_mutex };
+            waiting = true;
+            const bool woken = pool_not_empty.wait_until(
+              l, deadline, [&]() { return !ingest.empty(); });
+            waiting = false;
+            if (!woken) {
+                return;
+            }
+        }
+        drain();
+        take(columns, reduced_cost, threshold);
+    }
 }
 
 #endif
@@ -1,11 +1,5 @@
 #include "coordinates.h"
 
-double
-coordinate_tools::square(double x)
-{
-    return x * x;
-}
-
 double
 coordinate_tools::cosinus_gamma(double a, double b, double c)
 {
@@ -14,34 +8,12 @@ coordinate_tools::cosinus_gamma(double a, double b, double c)
     return r;
 }
 
-double
-coordinate_tools::lower_cosinus_gamma(double a, double b, double c)
-{
-    double r = (a * a + b * b - square(c + 1.0)) / (2.0 * (a + 1.0) * b);
-    return r;
-}
-
-double
-coordinate_tools::upper_cosinus_gamma(double a, double b, double c)
-{
-    double r = (square(a + 1) + b * b - c * c) / (2.0 * a * b);
-    return r;
-}
-
 double
 coordinate_tools::squared_length_of_c(double a, double b, double cosinus_gamma)
 {
     return a * a + b * b - 2.0 * a * b * cosinus_gamma;
 }
 
-double
-coordinate_tools::lower_squared_length_of_c(double a,
-                                            double b,
-                                            double cosinus_gamma)
-{
-    return a * a + b * b - 2.0 * (a + 1.0) * b * cosinus_gamma;
-}
-
 bounds operator*(double d, bounds b)
 {
     //the constructor swaps them for negative d
@@ -77,12 +49,12 @@ bounds::operator-(bounds b)
 
 bounds bounds::operator*(bounds b)
 {
-    const std::vector<double> values{
+    const std::initializer_list<double> values{
         lower * b.lower, lower * b.upper, upper * b.lower, upper * b.upper
     };
     bounds ret{
-        *std::min_element(values.begin(), values.end()),
-        *std::max_element(values.begin(), values.end()),
+        std::min(values),
+        std::max(values),
     };
     return ret;
 }
@@ -91,15 +63,15 @@ bounds
 bounds::operator/(bounds b)
 {
     assert_that(b.lower > 0 || b.upper < 0, "Cannot divide by 0!");
-    const std::vector<double> values{
+    const std::initializer_list<double> values{
         lower / b.lower,
         upper / b.lower,
         lower / b.upper,
         upper / b.upper,
     };
     bounds ret{
-        *std::min_element(values.begin(), values.end()),
-        *std::max_element(values.begin(), values.end()),
+        std::min(values),
+        std::max(values),
     };
     return ret;
 }
@@ -177,14 +149,6 @@ operator<<(std::ostream& os, bounds b)
     return os;
 }
 
-double
-coordinate_tools::upper_squared_length_of_c(double a,
-                                            double b,
-                                            double cosinus_gamma)
-{
-    return square(a + 1.0) + b * b - 2.0 * a * b * cosinus_gamma;
-}
-
 bool
 coordinate_tools::right_cosine(double left,
                                double upper,
@@ -234,6 +198,107 @@ coordinate_tools::check_left_length(double left,
            right_cosine(left, upper, right, _dummy, _dummy2);
 }
 
+tof_feasibility_batch::tof_feasibility_batch(unsigned elements,
+                                             unsigned capacity,
+                                             double element_pitch_in_tacts)
+  : elements(elements)
+  , capacity(capacity)
+  , candidates(0)
+  , double_element_pitch_in_tacts(2 * element_pitch_in_tacts)
+  , diagonals(elements, capacity)
+  , feasible(capacity)
+  , empty_interval(capacity)
+  , lower_cosine(capacity)
+  , upper_cosine(capacity)
+{
+    assert_that(elements != 0, "ToF-Iterator cannot be empty");
+}
+
+void
+tof_feasibility_batch::clear()
+{
+    candidates = 0;
+}
+
+bool
+tof_feasibility_batch::full() const
+{
+    return candidates == capacity;
+}
+
+void
+tof_feasibility_batch::check()
+{
+    bool* const ok = &feasible.at(0);
+    bool* const empty = &empty_interval.at(0);
+    std::fill(ok, ok + candidates, true);
+    std::fill(empty, empty + candidates, false);
+    if (elements == 1 || candidates == 0) {
+        return;
+    }
+
+    const unsigned* const first = &diagonals.at(0, 0);
+    const unsigned* const last = &diagonals.at(elements - 1, 0);
+    double* const lower_cos = &lower_cosine.at(0);
+    double* const upper_cos = &upper_cosine.at(0);
+
+    // For 2 elements: just check the cosine
+    const double outer = elements * double_element_pitch_in_tacts;
+    for (unsigned c = 0; c < candidates; c++) {
+        const double right = last[c];
+        lower_cos[c] =
+          coordinate_tools::lower_cosinus_gamma(right, outer, first[c]);
+        upper_cos[c] =
+          coordinate_tools::upper_cosinus_gamma(right, outer, first[c]);
+        empty[c] = !(lower_cos[c] <= upper_cos[c]);
+        ok[c] = !empty[c] && lower_cos[c] <= 1 && upper_cos[c] >= -1;
+    }
+
+    // For more then 2 elements: check cosine and lengths.
+    const double epsylon = 5e-2;
+    for (unsigned e = 1; e + 1 < elements; e++) {
+        const unsigned* const current = &diagonals.at(e, 0);
+        const double upper = (elements - e) * double_element_pitch_in_tacts;
+
+        for (unsigned c = 0; c < candidates; c++) {
+            const double left = current[c];
+            const double right = last[c];
+
+            const double lower_theoretical_left_sq =
+              coordinate_tools::lower_squared_length_of_c(
+                right, upper, upper_cos[c]);
+            const double upper_theoretical_left_sq =
+              coordinate_tools::upper_squared_length_of_c(
+                right, upper, lower_cos[c]);
+            const double lower_epsylon =
+              -2.0 * std::sqrt(lower_theoretical_left_sq) * epsylon -
+              epsylon * epsylon;
+            const double upper_epsylon =
+              2.0 * std::sqrt(upper_theoretical_left_sq) * epsylon +
+              epsylon * epsylon;
+
+            const bool length_ok =
+              left * left <= upper_theoretical_left_sq + upper_epsylon &&
+              lower_theoretical_left_sq - lower_epsylon <=
+                (left + 1) * (left + 1);
+
+            const double left_lower_cos =
+              coordinate_tools::lower_cosinus_gamma(right, upper, left);
+            const double left_upper_cos =
+              coordinate_tools::upper_cosinus_gamma(right, upper, left);
+            const bool cosine_ok = left_lower_cos <= 1 && left_upper_cos >= -1;
+
+            // mirrors the scalar version: empty intervals only count for candidates that were not rejected before.
+            const bool degenerated =
+              ok[c] &&
+              (!(lower_theoretical_left_sq <= upper_theoretical_left_sq) ||
+               (length_ok && !(left_lower_cos <= left_upper_cos)));
+            empty[c] = empty[c] || degenerated;
+            ok[c] = ok[c] && !degenerated && length_ok && cosine_ok;
+        }
+    }
+}
+
 tikz_center_printer::tikz_center_printer(std::ostream& os,
                                          double width_in_m,
                                          double height_in_m,
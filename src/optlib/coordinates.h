@@ -160,7 +160,7 @@ class coordinate_tools
                                   double lower_cos,
                                   double upper_cos);
 
-    /// Checks if a tof is valid.
+    /// Checks if a tof is valid, throws when an interval of the check is empty.
     template<typename InputIt>
     static bool tof_feasible_in_range(InputIt start,
                                       InputIt end,
@@ -168,6 +168,43 @@ class coordinate_tools
                                       double element_pitch_in_tacts);
 };
 
+// the scalar kernels are defined here so that the loops of tof_feasibility_batch can inline and vectorise them.
+inline double
+coordinate_tools::square(double x)
+{
+    return x * x;
+}
+
+inline double
+coordinate_tools::lower_cosinus_gamma(double a, double b, double c)
+{
+    double r = (a * a + b * b - square(c + 1.0)) / (2.0 * (a + 1.0) * b);
+    return r;
+}
+
+inline double
+coordinate_tools::upper_cosinus_gamma(double a, double b, double c)
+{
+    double r = (square(a + 1) + b * b - c * c) / (2.0 * a * b);
+    return r;
+}
+
+inline double
+coordinate_tools::lower_squared_length_of_c(double a,
+                                            double b,
+                                            double cosinus_gamma)
+{
+    return a * a + b * b - 2.0 * (a + 1.0) * b * cosinus_gamma;
+}
+
+inline double
+coordinate_tools::upper_squared_length_of_c(double a,
+                                            double b,
+                                            double cosinus_gamma)
+{
+    return square(a + 1.0) + b * b - 2.0 * a * b * cosinus_gamma;
+}
+
 template<typename InputIt>
 bool
 coordinate_tools::tof_feasible_in_range(InputIt start,
@@ -210,6 +247,66 @@ coordinate_tools::tof_feasible_in_range(InputIt start,
     return true;
 }
 
+/// @brief Checks the feasibility of many tofs at once.
+///
+/// Takes the same decisions as coordinate_tools::tof_feasible_in_range, but the diagonals of the candidates are stored as structure of arrays:
+/// diagonals(e, c) is the e-th diagonal entry of candidate c. Each check step runs over the contiguous entries of all candidates
+/// and no memory is allocated after construction.
+/// Where the scalar version throws for an empty interval, only the concerned candidate is rejected and marked in empty_interval.
+struct tof_feasibility_batch
+{
+    tof_feasibility_batch(unsigned elements,
+                          unsigned capacity,
+                          double element_pitch_in_tacts);
+
+    /// Number of diagonal entries per candidate.
+    const unsigned elements;
+    /// Maximal number of candidates that can be checked at once.
+    const unsigned capacity;
+    /// Number of candidates added since last clear().
+    unsigned candidates;
+
+    const double double_element_pitch_in_tacts;
+
+    /// The diagonals of the candidates, diagonals(e, c) is tof_{ee} of candidate c.
+    arr_2d<arr, unsigned> diagonals;
+    /// Filled by check(), feasible(c) is true when candidate c is a valid tof.
+    arr_1d<arr, bool> feasible;
+    /// Filled by check(), true when the check of candidate c met an empty interval (tof_feasible_in_range would throw).
+    arr_1d<arr, bool> empty_interval;
+    /// Cosine bounds given by the first and the last element of each candidate.
+    arr_1d<arr, double> lower_cosine;
+    /// Cosine bounds given by the first and the last element of each candidate.
+    arr_1d<arr, double> upper_cosine;
+
+    /// Removes all candidates.
+    void clear();
+    /// True when no more candidates can be added.
+    bool full() const;
+
+    /// Adds the diagonal [start, end) as new candidate and returns its index.
+    template<typename InputIt>
+    unsigned add(InputIt start, InputIt end);
+
+    /// Checks all added candidates and fills feasible.
+    void check();
+};
+
+template<typename InputIt>
+unsigned
+tof_feasibility_batch::add(InputIt start, InputIt end)
+{
+    assert_that(!full(), "Batch is full!");
+    const unsigned c = candidates++;
+    unsigned e = 0;
+    for (; start != end; ++start, ++e) {
+        assert(e < elements);
+        diagonals(e, c) = *start;
+    }
+    assert(e == elements);
+    return c;
+}
+
 /// Point with (x,y) coordinates.
 template<typename T = double>
 class cartesian
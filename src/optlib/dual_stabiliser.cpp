@@ -0,0 +1,101 @@
+#include "dual_stabiliser.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+dual_stabiliser::dual_stabiliser(mode m, double alpha, double box)
+  : m(m)
+  , alpha(alpha)
+  , box(box)
+{
+    assert(alpha >= 0.0 && alpha < 1.0 && "Smoothing needs 0 <= alpha < 1!");
+    assert(box > 0.0 && "Box needs a positive width!");
+}
+
+bool
+dual_stabiliser::active() const
+{
+    return m != NONE;
+}
+
+double
+dual_stabiliser::current_alpha() const
+{
+    return std::max(0.0, 1.0 - (sequence + 1) * (1.0 - alpha));
+}
+
+double
+dual_stabiliser::current_box() const
+{
+    return box * std::pow(2.0, sequence);
+}
+
+bool
+dual_stabiliser::separation_point(const arr<>& master_dual, arr<>& separation)
+{
+    sequence = 0;
+    return compute(master_dual, separation);
+}
+
+bool
+dual_stabiliser::compute(const arr<>& master_dual, arr<>& separation)
+{
+    assert(master_dual.same_dim(separation) && "Incompatible dimensions!");
+    if (centre.empty()) {
+        centre.assign(master_dual.size(), 0.0);
+    }
+
+    const double* master = master_dual.data;
+    double step = 1.0;
+    switch (m) {
+        case NONE: {
+            break;
+        }
+        case WENTGES:
+        case IN_OUT: {
+            step = 1.0 - current_alpha();
+            break;
+        }
+        case BOX_STEP: {
+            double distance = 0.0;
+            for (unsigned r = 0; r < centre.size(); r++) {
+                distance = std::max(distance, std::abs(master[r] - centre[r]));
+            }
+            // scale the whole step (not every entry) so that the point stays between centre and master dual.
+            if (distance > current_box()) {
+                step = current_box() / distance;
+            }
+            break;
+        }
+    }
+
+    if (step >= 1.0) {
+        std::copy(master, master + master_dual.size(), separation.data);
+        return false;
+    }
+    for (unsigned r = 0; r < centre.size(); r++) {
+        separation.data[r] = centre[r] + step * (master[r] - centre[r]);
+    }
+    return true;
+}
+
+bool
+dual_stabiliser::mispriced(arr<>& separation,
+                           const arr<>& master_dual,
+                           const arr<>& measurement)
+{
+    assert(separation.same_dim(measurement) && "Incompatible dimensions!");
+    mispricings++;
+    sequence++;
+
+    const double bound = std::inner_product(separation.data,
+                                            separation.data + separation.size(),
+                                            measurement.data,
+                                            0.0);
+    if (m == IN_OUT || bound > centre_bound) {
+        centre.assign(separation.data, separation.data + separation.size());
+        centre_bound = bound;
+    }
+    return compute(master_dual, separation);
+}
@@ -0,0 +1,65 @@
+#ifndef DUAL_STABILISER_H
+#define DUAL_STABILISER_H
+
+#include "arr.h"
+#include <vector>
+
+///@brief Dual stabilisation for the column generation.
+///
+/// The slaves do not separate the master dual directly but a point between the master dual and a stability centre.
+/// The centre is always dual feasible: it starts with 0 (every column has a reduced cost of 0 there) and is only replaced by
+/// separation points for which the slaves proved that no column separates them.
+/// Because the centre is feasible and the separation point lies between centre and master dual, every column separating
+/// the separation point also separates the master dual.
+/// When the slaves find nothing (mis-pricing), the separation point becomes a centre candidate and the next separation point
+/// moves towards the master dual, until the master dual itself is priced.
+struct dual_stabiliser
+{
+    enum mode : unsigned
+    {
+        NONE = 0,
+        /// separation = alpha * centre + (1 - alpha) * master, the centre is the feasible dual with the best bound.
+        WENTGES = 1,
+        /// Same separation point, but the centre (in-point) is replaced by every feasible separation point.
+        IN_OUT = 2,
+        /// The largest step from the centre towards the master dual that stays in a box of half width box around the centre.
+        BOX_STEP = 3,
+    };
+
+    dual_stabiliser(mode m, double alpha, double box);
+
+    mode m;
+    double alpha;
+    double box;
+
+    /// The stability centre, flattened like the dual.
+    std::vector<double> centre;
+    /// measurement^T centre, a lower bound of the master objective.
+    double centre_bound = 0.0;
+    /// Number of separation points the slaves could not separate.
+    unsigned mispricings = 0;
+    /// Number of mis-pricings for the current master dual.
+    unsigned sequence = 0;
+
+    bool active() const;
+
+    /// Computes the point that the slaves should separate for a new master dual, returns false if it equals the master dual.
+    bool separation_point(const arr<>& master_dual, arr<>& separation);
+
+    /// @brief The slaves found no column for separation : separation is feasible and may become the new centre.
+    ///
+    /// Writes the next separation point into separation, returns false when the master dual itself has to be priced.
+    bool mispriced(arr<>& separation,
+                   const arr<>& master_dual,
+                   const arr<>& measurement);
+
+  protected:
+    /// Weight of the centre for the current sequence (Wentges and in-out).
+    double current_alpha() const;
+    /// Box width for the current sequence (box-step).
+    double current_box() const;
+    /// Computes the separation point for the current sequence, returns false if it equals the master dual.
+    bool compute(const arr<>& master_dual, arr<>& separation);
+};
+
+#endif
@@ -0,0 +1,269 @@
+#include "geometric_slave.h"
+
+geometric_slave::geometric_slave(double element_pitch_in_tacts,
+                                 std::optional<double> slavestop,
+                                 unsigned offset,
+                                 std::optional<double> horizontal_roi_start,
+                                 std::optional<double> horizontal_roi_end,
+                                 std::ostream& output,
+                                 bool verbose)
+  : element_pitch_in_tacts(element_pitch_in_tacts)
+  , slavestop(slavestop)
+  , offset(offset)
+  , horizontal_roi_start(horizontal_roi_start)
+  , horizontal_roi_end(horizontal_roi_end)
+  , output(output)
+  , verbose(verbose)
+{}
+
+void
+geometric_slave::add_solution_start_hints(size, std::vector<time_of_flight>& h)
+{
+    for (const time_of_flight& tof : h) {
+        time_of_flight copy(tof.senders, tof.receivers, tof.representant_x);
+        std::copy(tof.begin(), tof.end(), copy.begin());
+        hints.push_back(std::move(copy));
+    }
+}
+
+void
+geometric_slave::prepare_for_solving(proxy_arr<double>& f)
+{
+    assert(f.dim1 == f.dim2);
+    elements = f.dim1;
+    samples = f.dim3;
+
+    position.resize(elements);
+    for (unsigned e = 0; e < elements; e++) {
+        position[e] = 2.0 * e * element_pitch_in_tacts;
+    }
+
+    const unsigned pairs = elements * (elements + 1) / 2;
+    const unsigned blocks = (samples + block - 1) / block;
+    objective.realloca(pairs, samples);
+    block_maxima.realloca(pairs, blocks);
+    unsigned p = 0;
+    for (unsigned i = 0; i < elements; i++) {
+        for (unsigned j = i; j < elements; j++, p++) {
+            for (unsigned k = 0; k < samples; k++) {
+                objective.at(p, k) =
+                  i == j ? f(i, i, k) : f(i, j, k) + f(j, i, k);
+            }
+            for (unsigned b = 0; b < blocks; b++) {
+                const double* start = &objective.at(p, b * block);
+                block_maxima.at(p, b) = *std::max_element(
+                  start, start + std::min(block, samples - b * block));
+            }
+        }
+    }
+    k_at.resize(pairs);
+}
+
+double
+geometric_slave::max_in_range(unsigned p, unsigned first, unsigned last) const
+{
+    assert(first <= last && last < samples);
+    const double* row = objective.begin() + p * samples;
+    const unsigned first_block = first / block;
+    const unsigned last_block = last / block;
+    if (first_block == last_block) {
+        return *std::max_element(row + first, row + last + 1);
+    }
+    double best = *std::max_element(row + first, row + (first_block + 1) * block);
+    best = std::max(
+      best, *std::max_element(row + last_block * block, row + last + 1));
+    for (unsigned b = first_block + 1; b < last_block; b++) {
+        best = std::max(best, block_maxima.at(p, b));
+    }
+    return best;
+}
+
+bounds
+geometric_slave::distance(const box& b, unsigned e) const
+{
+    const double left = b.x_lower - position[e];
+    const double right = b.x_upper - position[e];
+    // bounds::square() only holds for intervals that do not contain 0.
+    const double horizontal_lower =
+      left <= 0.0 && right >= 0.0 ? 0.0 : std::min(left * left, right * right);
+    const double horizontal_upper = std::max(left * left, right * right);
+    return (bounds{ horizontal_lower, horizontal_upper } +
+            bounds{ b.y_lower, b.y_upper }.square())
+      .root();
+}
+
+std::optional<double>
+geometric_slave::upper_bound(const box& b, bool& exact)
+{
+    std::vector<bounds> distances;
+    distances.reserve(elements);
+    for (unsigned e = 0; e < elements; e++) {
+        distances.push_back(distance(b, e));
+    }
+
+    double bound = 0.0;
+    exact = true;
+    unsigned p = 0;
+    for (unsigned i = 0; i < elements; i++) {
+        for (unsigned j = i; j < elements; j++, p++) {
+            const bounds tof = 0.5 * (distances[i] + distances[j]);
+            const double first = std::floor(tof.lower) - offset;
+            const double last = std::floor(tof.upper) - offset;
+            if (last < 0.0 || first >= samples) {
+                return std::nullopt;
+            }
+            exact = exact && first == last;
+            bound += max_in_range(p,
+                                  (unsigned)std::max(first, 0.0),
+                                  (unsigned)std::min(last, samples - 1.0));
+        }
+    }
+    return bound;
+}
+
+std::optional<double>
+geometric_slave::evaluate(double x, double y)
+{
+    std::vector<double> distances(elements);
+    for (unsigned e = 0; e < elements; e++) {
+        distances[e] = std::sqrt(std::pow(x - position[e], 2) + y * y);
+    }
+
+    double value = 0.0;
+    unsigned p = 0;
+    for (unsigned i = 0; i < elements; i++) {
+        for (unsigned j = i; j < elements; j++, p++) {
+            const double k =
+              std::floor(0.5 * (distances[i] + distances[j])) - offset;
+            if (k < 0.0 || k >= samples) {
+                return std::nullopt;
+            }
+            k_at[p] = (unsigned)k;
+            value += objective.at(p, k_at[p]);
+        }
+    }
+    return value;
+}
+
+void
+geometric_slave::run(proxy_arr<double>& f, columns& vars)
+{
+    stop_watch time;
+    prepare_for_solving(f);
+
+    double incumbent = -std::numeric_limits<double>::infinity();
+    int solutions = 0;
+    auto improve = [&](double value, double x) {
+        if (value > incumbent) {
+            incumbent = value;
+            best_k = k_at;
+            best_x = x;
+            solutions++;
+        }
+    };
+
+    for (const time_of_flight& hint : hints) {
+        double value = 0.0;
+        bool feasible = hint.senders == elements;
+        unsigned p = 0;
+        for (unsigned i = 0; i < elements && feasible; i++) {
+            for (unsigned j = i; j < elements && feasible; j++, p++) {
+                const int k = (int)hint.at(i, j) - (int)offset;
+                feasible = k >= 0 && k < (int)samples;
+                if (feasible) {
+                    k_at[p] = k;
+                    value += objective.at(p, k);
+                }
+            }
+        }
+        if (feasible) {
+            improve(value, hint.representant_x.value_or(0.0));
+        }
+    }
+
+    // positions farther away than max_distance from all elements have no tof inside of the samples.
+    const double max_distance = offset + samples;
+    box root{ horizontal_roi_start.value_or(-max_distance),
+              horizontal_roi_end.value_or(position.back() + max_distance),
+              0.0,
+              max_distance,
+              0.0 };
+
+    std::priority_queue<box> open;
+    // boxes too small to split are dropped, but their bound still limits the objective.
+    double dropped_bound = -std::numeric_limits<double>::infinity();
+    explored_boxes = 0;
+    auto push = [&](box b) {
+        explored_boxes++;
+        const double center_x = 0.5 * (b.x_lower + b.x_upper);
+        if (std::optional<double> value =
+              evaluate(center_x, 0.5 * (b.y_lower + b.y_upper))) {
+            improve(*value, center_x);
+        }
+        bool exact;
+        std::optional<double> bound = upper_bound(b, exact);
+        if (!bound || *bound <= incumbent) {
+            return;
+        }
+        // all positions of an exact box have the tof of its center, which was already evaluated.
+        const bool too_small = b.x_upper - b.x_lower < min_box_width &&
+                               b.y_upper - b.y_lower < min_box_width;
+        if (exact) {
+            return;
+        }
+        if (too_small) {
+            dropped_bound = std::max(dropped_bound, *bound);
+            return;
+        }
+        b.bound = *bound;
+        open.push(b);
+    };
+
+    push(root);
+    while (!open.empty()) {
+        const box b = open.top();
+        if (b.bound <= incumbent || (slavestop && incumbent >= *slavestop)) {
+            break;
+        }
+        open.pop();
+
+        if (b.x_upper - b.x_lower >= b.y_upper - b.y_lower) {
+            const double middle = 0.5 * (b.x_lower + b.x_upper);
+            push({ b.x_lower, middle, b.y_lower, b.y_upper, 0.0 });
+            push({ middle, b.x_upper, b.y_lower, b.y_upper, 0.0 });
+        } else {
+            const double middle = 0.5 * (b.y_lower + b.y_upper);
+            push({ b.x_lower, b.x_upper, b.y_lower, middle, 0.0 });
+            push({ b.x_lower, b.x_upper, middle, b.y_upper, 0.0 });
+        }
+    }
+    assert_that(solutions > 0, "No position has a tof inside of the samples!");
+
+    double bound = std::max(incumbent, dropped_bound);
+    if (!open.empty()) {
+        bound = std::max(bound, open.top().bound);
+    }
+    if (verbose) {
+        output << "(GeometricSlave) Explored " << explored_boxes
+               << " boxes, objective " << incumbent << ", bound " << bound
+               << std::endl;
+    }
+
+    time_of_flight tof(elements, elements, best_x);
+    unsigned p = 0;
+    for (unsigned i = 0; i < elements; i++) {
+        for (unsigned j = i; j < elements; j++, p++) {
+            tof.at(i, j) = best_k[p] + offset;
+            tof.at(j, i) = best_k[p] + offset;
+        }
+    }
+    vars.push_back({ std::move(tof),
+                     {
+                       incumbent,
+                       time.elapsed(),
+                       incumbent,
+                       bound,
+                       (double)explored_boxes,
+                       solutions,
+                     } });
+}
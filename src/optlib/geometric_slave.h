@@ -0,0 +1,106 @@
+#ifndef GEOMETRIC_SLAVE_H
+#define GEOMETRIC_SLAVE_H
+
+#include "arr.h"
+#include "coordinates.h"
+#include "slave_problem.h"
+#include "statistics.h"
+#include "stop_watch.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <vector>
+
+///@brief A slave_problem implementation that does not need Gurobi.
+///
+/// A column is determined by the position (x, y) of its reflector, so the slave branches on boxes in (x, y) space.
+/// Uses the same units as grb_slave: x, y and the element positions 2 * e * pitch are scaled like the distances (round trip),
+/// so tof_{ij} = floor((distance_i + distance_j) / 2).
+/// The distances of a box to each element are bounded with interval arithmetic, which gives an interval of reachable tofs for every
+/// sender-receiver-pair. The sum of the best objective of every pair over its interval bounds the objective of the whole box.
+/// Boxes are explored best bound first and pruned against the incumbent, the result is optimal up to min_box_width.
+class geometric_slave : public slave_problem
+{
+  public:
+    geometric_slave(double element_pitch_in_tacts,
+                    std::optional<double> slavestop,
+                    unsigned offset,
+                    std::optional<double> horizontal_roi_start,
+                    std::optional<double> horizontal_roi_end,
+                    std::ostream& output,
+                    bool verbose);
+
+    /// A box [x_lower, x_upper] x [y_lower, y_upper] with the upper bound of its objective.
+    struct box
+    {
+        double x_lower, x_upper, y_lower, y_upper;
+        double bound;
+
+        bool operator<(const box& b) const { return bound < b.bound; }
+    };
+
+    double element_pitch_in_tacts;
+    std::optional<double> slavestop;
+    unsigned offset;
+    std::optional<double> horizontal_roi_start;
+    std::optional<double> horizontal_roi_end;
+    std::ostream& output;
+    bool verbose;
+
+    /// Boxes smaller than min_box_width (in both directions) are not split anymore, only their center is evaluated.
+    double min_box_width = 1e-3;
+
+    /// Number of boxes whose bound was computed in the last run.
+    unsigned explored_boxes = 0;
+
+    void run(proxy_arr<double>& f, columns& vars) override;
+
+    /// The hints are evaluated at the start of every run and serve as first incumbent.
+    void add_solution_start_hints(size size,
+                                  std::vector<time_of_flight>& hints) override;
+
+    /// @brief Upper bound of the objective of all positions in b, nullopt when no position in b gives a tof inside of the samples.
+    ///
+    /// exact is set to true when all positions in b have the same tof, the bound is their objective then.
+    std::optional<double> upper_bound(const box& b, bool& exact);
+
+    /// Objective of the position (x, y), nullopt when its tof does not lie inside of the samples. Fills k_at with the k of every pair.
+    std::optional<double> evaluate(double x, double y);
+
+  protected:
+    /// Sums the symmetric entries of f into objective and computes the block maxima.
+    void prepare_for_solving(proxy_arr<double>& f);
+
+    /// Largest objective of pair p with k in [first, last].
+    double max_in_range(unsigned p, unsigned first, unsigned last) const;
+
+    /// Returns the interval of the distance between the positions in b and element e.
+    bounds distance(const box& b, unsigned e) const;
+
+    unsigned elements = 0;
+    unsigned samples = 0;
+    /// objective(p, k) is the objective of choosing k for sender-receiver-pair p (i <= j, ordered by i first).
+    arr_2d<arr, double> objective{ 0, 0, nullptr };
+    /// block_maxima(p, b) is the largest objective(p, k) of block b.
+    arr_2d<arr, double> block_maxima{ 0, 0, nullptr };
+    /// Element positions.
+    std::vector<double> position;
+
+    /// The k of every pair of the last evaluated position.
+    std::vector<unsigned> k_at;
+    /// The k of every pair of the incumbent.
+    std::vector<unsigned> best_k;
+    /// The x-representant of the incumbent.
+    double best_x = 0.0;
+
+    std::vector<time_of_flight> hints;
+
+    /// Width of the blocks of block_maxima.
+    static constexpr unsigned block = 32;
+};
+
+#endif
@@ -1,24 +1,102 @@
 #include "grb_column_generation.h"
 
+/// Creates the exact master selected by c.
+static master_problem*
+create_exact_master(GRBEnv* e, const config& c, std::ostream& output)
+{
+    if (c.in_house_master) {
+        return new simplex_master(c.verbose,
+                                  output,
+                                  (master_problem::solver)c.master_solver,
+                                  c.master_solution_threshold.value_or(0.0));
+    }
+    grb_master* master =
+      new grb_master(e,
+                     c.verbose,
+                     output,
+                     (master_problem::solver)c.master_solver,
+                     c.master_solution_threshold.value_or(0.0));
+    master->names = !c.no_master_names;
+    master->lazy_rows = c.lazy_rows;
+    if (c.adaptive_master_solver) {
+        master->adaptive.emplace(
+          std::vector<master_problem::solver>{ master_problem::SIMPLEX,
+                                               master_problem::DUAL_SIMPLEX,
+                                               master_problem::BARRIER,
+                                               master_problem::CONCURRENT },
+          c.adaptive_exploration);
+    }
+    return master;
+}
+
+/// Creates the master selected by c.
+static master_problem*
+create_master(GRBEnv* e, const config& c, std::ostream& output)
+{
+    if (c.pdhg_master) {
+        return new pdhg_master<fftw_arr>(
+          c.verbose,
+          output,
+          (master_problem::solver)c.master_solver,
+          c.master_solution_threshold.value_or(0.0),
+          new fourier_convolution(),
+          new fourier_convolution(),
+          c.pdhg_polish ? create_exact_master(e, c, output) : nullptr);
+    }
+    return create_exact_master(e, c, output);
+}
+
+/// Creates the slave selected by c instead of grb_slave, nullptr when grb_slave is used.
+static slave_problem*
+create_selected_slave(GRBEnv* e, const config& c, std::ostream& output)
+{
+    if (c.geometric_slave) {
+        return new geometric_slave(c.pitch * c.sampling_rate / c.wave_speed,
+                                   c.slavestop,
+                                   c.get_roi_start(),
+                                   c.horizontal_roi_start,
+                                   c.horizontal_roi_end,
+                                   output,
+                                   c.verbose);
+    }
+    if (c.diagonal_slave) {
+        auto slave =
+          new grb_diagonal_slave(e,
+                                 c.pitch * c.sampling_rate / c.wave_speed,
+                                 c.slavestop,
+                                 c.get_roi_start(),
+                                 c.horizontal_roi_start,
+                                 c.horizontal_roi_end,
+                                 c.slave_threshold,
+                                 output,
+                                 new grb_to_file(output),
+                                 c.verbose);
+        slave->exact.presolve = c.slave_presolve;
+        return slave;
+    }
+    return nullptr;
+}
+
 grb_cg::grb_cg(config c, arr<>& measurement, arr<>& reference_signal)
   : column_generation(c, measurement, reference_signal)
 {
     e = new GRBEnv();
-    master = new grb_master(e,
-                            c.verbose,
-                            output,
-                            (master_problem::solver)c.master_solver,
-                            c.master_solution_threshold.value_or(0.0));
+    master = create_master(e, c, output);
     conv = new fourier_convolution();
-    slave = new grb_slave(e,
-                          c.pitch * c.sampling_rate / c.wave_speed,
-                          c.slavestop,
-                          c.get_roi_start(),
-                          c.horizontal_roi_start,
-                          c.horizontal_roi_end,
-                          output,
-                          new grb_to_file(output),
-                          c.verbose);
+    slave = create_selected_slave(e, c, output);
+    if (!slave) {
+        auto _slave = new grb_slave(e,
+                                    c.pitch * c.sampling_rate / c.wave_speed,
+                                    c.slavestop,
+                                    c.get_roi_start(),
+                                    c.horizontal_roi_start,
+                                    c.horizontal_roi_end,
+                                    output,
+                                    new grb_to_file(output),
+                                    c.verbose);
+        _slave->presolve = c.slave_presolve;
+        slave = _slave;
+    }
     instance =
       new column_generation_run<fftw_arr>(measurement, reference_signal, c);
 }
@@ -54,31 +132,58 @@ grb_cg_multi_slaves::grb_cg_multi_slaves(config c,
   : column_generation(c, measurement, reference_signal)
 {
     //master = new slow_grb_master(e, c.verbose, output, c.master_solution_threshold);
-    master = new grb_master(&e,
-                            c.verbose,
-                            output,
-                            (master_problem::solver)c.master_solver,
-                            c.master_solution_threshold.value_or(0.0));
+    master = create_master(&e, c, output);
     conv = new fourier_convolution();
     // _instance needed to get the constraint pool before casting to interface
     auto _instance = new column_generation_run_async<fftw_arr>(
       measurement, reference_signal, c);
-    slave = new grb_multiple_slave_async{
-        c.pitch * c.sampling_rate / c.wave_speed,
-        c.slave_threshold,
-        c.slavestop,
-        c.get_roi_start(),
-        c.horizontal_roi_start,
-        c.horizontal_roi_end,
-        output,
-        c.verbose,
-        slave_count,
-        _instance->pool,
-        _instance->can_print,
-        slave_cuts,
-        c.output,
-        options,
-    };
+    _instance->pool.capacity = c.pool_capacity;
+    if (c.geometric_slave || c.diagonal_slave) {
+        single_slave = std::make_unique<threaded_slave>(
+          [&](std::ostream& slave_output) {
+              return std::unique_ptr<slave_problem>(
+                create_selected_slave(&e, c, slave_output));
+          },
+          _instance->pool,
+          output);
+        slave = single_slave.get();
+    } else {
+        auto _slave = new grb_multiple_slave_async{
+            c.pitch * c.sampling_rate / c.wave_speed,
+            c.slave_threshold,
+            c.slavestop,
+            c.get_roi_start(),
+            c.horizontal_roi_start,
+            c.horizontal_roi_end,
+            output,
+            c.verbose,
+            slave_count,
+            _instance->pool,
+            _instance->can_print,
+            slave_cuts,
+            c.output,
+            options,
+            c.slave_portfolio,
+            c.strip_overlap,
+        };
+        for (auto& async_slave : _slave->slave_pool) {
+            async_slave.presolve = c.slave_presolve;
+        }
+        if (c.pipeline_batch > 0) {
+            _slave->max_dual_age = c.pipeline_dual_age;
+        }
+        slave = _slave;
+    }
+    if (c.local_search_radius > 0) {
+        constraint_pool& pool = _instance->pool;
+        _instance->local_search = std::make_unique<local_search_slave>(
+          c.pitch * c.sampling_rate / c.wave_speed,
+          c.local_search_radius,
+          c.local_search_steps,
+          c.get_roi_start(),
+          c.slave_threshold,
+          [&pool](column&& col) { pool.add_to_current(std::move(col)); });
+    }
     instance = _instance;
 }
 
@@ -94,21 +199,19 @@ grb_cg_wavelength_precision::grb_cg_wavelength_precision(
   , tacts_pro_wavelength(c.sampling_rate * c.wave_length / c.wave_speed)
 {
     e = new GRBEnv();
-    master = new grb_master(e,
-                            c.verbose,
-                            output,
-                            (master_problem::solver)c.master_solver,
-                            c.master_solution_threshold.value_or(0.0));
+    master = create_master(e, c, output);
     conv = new fourier_convolution();
-    slave = new grb_slave(e,
-                          c.pitch / c.wave_length,
-                          c.slavestop,
-                          c.get_roi_start(),
-                          c.horizontal_roi_start,
-                          c.horizontal_roi_end,
-                          output,
-                          new grb_to_file(output),
-                          c.verbose);
+    auto _slave = new grb_slave(e,
+                                c.pitch / c.wave_length,
+                                c.slavestop,
+                                c.get_roi_start(),
+                                c.horizontal_roi_start,
+                                c.horizontal_roi_end,
+                                output,
+                                new grb_to_file(output),
+                                c.verbose);
+    _slave->presolve = c.slave_presolve;
+    slave = _slave;
     if (!c.verbose) {
         print = new muted_printer();
         write = new muted_writer<double>();
@@ -7,13 +7,19 @@
 #include "coordinates.h"
 #include "fftw_arr.h"
 #include "fftw_convolution.h"
+#include "geometric_slave.h"
+#include "grb_diagonal_slave.h"
 #include "grb_master.h"
 #include "grb_multiple_slave_async.h"
+#include "pdhg_master.h"
 #include "printer.h"
+#include "simplex_master.h"
 #include "slave_problem.h"
+#include "threaded_slave.h"
 #include "writer.h"
 #include <fstream>
 #include <iomanip>
+#include <memory>
 #include <optional>
 #include <random>
 #include <vector>
@@ -32,7 +38,10 @@ class grb_cg : public column_generation
     GRBEnv* e;
 };
 
-/// Column Generation using fftw and gurobi and multiples slaves.
+/// @brief Column Generation using fftw and gurobi and multiples slaves.
+///
+/// With c.geometric_slave or c.diagonal_slave, a single slave of that kind runs in a threaded_slave instead of the async
+/// Gurobi slaves.
 class grb_cg_multi_slaves : public column_generation
 {
   public:
@@ -46,6 +55,8 @@ class grb_cg_multi_slaves : public column_generation
     virtual ~grb_cg_multi_slaves() override;
 
     GRBEnv e;
+    /// The slave without asynchronous mode selected by c, declared after e to be destroyed before it.
+    std::unique_ptr<threaded_slave> single_slave;
 };
 
 /// @brief A less precise columngeneration.
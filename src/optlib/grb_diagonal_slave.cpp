@@ -0,0 +1,213 @@
+#include "grb_diagonal_slave.h"
+
+grb_diagonal_slave::grb_diagonal_slave(
+  GRBEnv* e,
+  double element_pitch_in_tacts,
+  std::optional<double> slavestop,
+  unsigned offset,
+  std::optional<double> horizontal_roi_start,
+  std::optional<double> horizontal_roi_end,
+  double threshold,
+  std::ostream& output,
+  grb_resettable_callback* grb_callback,
+  bool verbose)
+  : element_pitch_in_tacts(element_pitch_in_tacts)
+  , slavestop(slavestop)
+  , offset(offset)
+  , horizontal_roi_start(horizontal_roi_start)
+  , horizontal_roi_end(horizontal_roi_end)
+  , threshold(threshold)
+  , output(output)
+  , verbose(verbose)
+  , vars_proxy(0, 0, 0, nullptr, false)
+  , diameter_vars_proxy(0, 0, nullptr, false)
+  , squared_vars_proxy(0, nullptr, false)
+  , model(*e)
+  , exact(e,
+          element_pitch_in_tacts,
+          slavestop,
+          offset,
+          horizontal_roi_start,
+          horizontal_roi_end,
+          output,
+          grb_callback,
+          verbose)
+{}
+
+slave_problem::variables<GRBVar>
+grb_diagonal_slave::variables()
+{
+    return {
+        vars_proxy,
+        diameter_vars_proxy,
+        squared_vars_proxy,
+
+        representant_x,
+    };
+}
+
+slave_problem::distance_mapping
+grb_diagonal_slave::mapping()
+{
+    return {
+        [&](unsigned k) { return k + offset; },
+        [&](unsigned distance) -> std::optional<unsigned> {
+            if (distance >= offset && distance < offset + vars_proxy.dim3) {
+                return distance - offset;
+            }
+            return std::nullopt;
+        },
+    };
+}
+
+void
+grb_diagonal_slave::generate(size f)
+{
+    if (generated) {
+        return;
+    }
+    assert(f.dim1 == f.dim2);
+
+    model.set(GRB_IntParam_OutputFlag, false);
+    model.set(GRB_StringAttr_ModelName, "diagonal_slave_problem");
+    model.set(GRB_IntAttr_ModelSense, GRB_MAXIMIZE);
+    if (slavestop) {
+        model.set(GRB_DoubleParam_BestObjStop, *slavestop);
+    }
+    const int max_distance = f.dim3 + offset;
+
+    representant_x = model.addVar(horizontal_roi_start.value_or(-max_distance),
+                                  horizontal_roi_end.value_or(max_distance),
+                                  0.0,
+                                  GRB_CONTINUOUS,
+                                  "x");
+    vars_proxy.realloca(
+      f.dim1,
+      f.dim2,
+      f.dim3,
+      model.addVars(diagonal_arr<proxy_arr<GRBVar>>::size(f), GRB_BINARY),
+      true);
+    diameter_vars_proxy.realloca(
+      f.dim1, f.dim2, model.addVars(f.dim1, GRB_CONTINUOUS), true);
+    squared_vars_proxy.realloca(
+      f.dim1, model.addVars(f.dim1, GRB_CONTINUOUS), true);
+
+    for (unsigned i = 0; i < f.dim1; i++) {
+        for (unsigned k = 0; k < f.dim3; k++) {
+            std::stringstream ss;
+            ss << "b_" << i << "_" << i << "_" << k;
+            vars_proxy(i, i, k).set(GRB_StringAttr_VarName, ss.str());
+        }
+        diameter_vars_proxy(i, i).set(GRB_StringAttr_VarName,
+                                      "d_" + std::to_string(i));
+        squared_vars_proxy(i).set(GRB_StringAttr_VarName,
+                                  "q_" + std::to_string(i));
+    }
+
+    grb_linear_expression_visitor glev{ variables() };
+    slave_constraint_generator scg{
+        f,
+        mapping(),
+        element_pitch_in_tacts,
+    };
+    scg.only_diagonal = true;
+    scg.all([&](linear_expression_constraint c) { model.addConstr(glev(c)); });
+
+    generated = true;
+}
+
+double
+grb_diagonal_slave::aggregated_objective(proxy_arr<double>& f,
+                                         unsigned i,
+                                         unsigned k)
+{
+    double value = f(i, i, k);
+    for (unsigned j = 0; j < f.dim2; j++) {
+        if (j != i) {
+            value += 0.5 * (f(i, j, k) + f(j, i, k));
+        }
+    }
+    return value;
+}
+
+void
+grb_diagonal_slave::run(proxy_arr<double>& f, columns& vars)
+{
+    generate(f);
+
+    std::vector<GRBVar> binaries;
+    std::vector<double> coefficients;
+    for (unsigned i = 0; i < f.dim1; i++) {
+        for (unsigned k = 0; k < f.dim3; k++) {
+            binaries.push_back(vars_proxy(i, i, k));
+            coefficients.push_back(aggregated_objective(f, i, k));
+        }
+    }
+    model.set(GRB_DoubleAttr_Obj,
+              binaries.data(),
+              coefficients.data(),
+              binaries.size());
+    model.optimize();
+
+    if (model.get(GRB_IntAttr_SolCount) > 0) {
+        time_of_flight tof(
+          f.dim1, f.dim2, representant_x.get(GRB_DoubleAttr_X));
+        for (unsigned i = 0; i < f.dim1; i++) {
+            for (unsigned k = 0; k < f.dim3; k++) {
+                if (vars_proxy(i, i, k).get(GRB_DoubleAttr_X) > 0.5) {
+                    tof.at(i, i) = k + offset;
+                }
+            }
+        }
+        tof.fill_from_diagonal();
+
+        // the mean of two diagonal tofs inside of the samples lies inside of the samples too.
+        double reduced_cost = 0.0;
+        for (unsigned i = 0; i < f.dim1; i++) {
+            for (unsigned j = 0; j < f.dim2; j++) {
+                reduced_cost += f(i, j, tof.at(i, j) - offset);
+            }
+        }
+
+        if (verbose) {
+            output << "(DiagonalSlave) aggregated objective "
+                   << model.get(GRB_DoubleAttr_ObjVal) << ", reduced cost "
+                   << reduced_cost << std::endl;
+        }
+        if (reduced_cost > threshold) {
+            compact_columns++;
+            // the aggregated objective does not bound the reduced cost.
+            vars.push_back({ std::move(tof),
+                             {
+                               reduced_cost,
+                               model.get(GRB_DoubleAttr_Runtime),
+                               reduced_cost,
+                               std::numeric_limits<double>::infinity(),
+                               model.get(GRB_DoubleAttr_NodeCount),
+                               model.get(GRB_IntAttr_SolCount),
+                             } });
+            return;
+        }
+    }
+
+    exact.run(f, vars);
+}
+
+void
+grb_diagonal_slave::add_solution_start_hints(size s,
+                                             std::vector<time_of_flight>& hints)
+{
+    generate(s);
+    exact.add_solution_start_hints(s, hints);
+
+    unsigned current_start = model.get(GRB_IntAttr_NumStart);
+    model.set(GRB_IntAttr_NumStart, current_start + hints.size());
+    for (time_of_flight& tof : hints) {
+        model.set(GRB_IntParam_StartNumber, current_start++);
+        for (unsigned i = 0; i < vars_proxy.dim1; i++) {
+            assert(vars_proxy.dim3 > tof.at(i, i) - offset);
+            vars_proxy(i, i, tof.at(i, i) - offset)
+              .set(GRB_DoubleAttr_Start, 1.0);
+        }
+    }
+}
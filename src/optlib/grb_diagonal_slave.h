@@ -0,0 +1,85 @@
+#ifndef GRB_DIAGONAL_SLAVE_H
+#define GRB_DIAGONAL_SLAVE_H
+
+#include "arr.h"
+#include "coordinates.h"
+#include "grb_callback.h"
+#include "grb_linear_expression.h"
+#include "grb_slave.h"
+#include "gurobi_c++.h"
+#include "slave_constraints_generator.h"
+#include "slave_problem.h"
+#include "statistics.h"
+#include "stop_watch.h"
+#include <cassert>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <vector>
+
+///@brief A compact Gurobi slave with binaries on the diagonal only.
+///
+/// grb_slave has N(N+1)/2 x samples binaries, but the off-diagonal tofs follow from the diagonal up to rounding
+/// (time_of_flight::fill_from_diagonal). This slave only keeps the binaries b_iik, the diameters d_ii, the quadratics
+/// and x, so the model has N x samples binaries.
+/// The off-diagonal objective is aggregated onto the diagonal: pair (i, j) counts half at k_i and half at k_j, which
+/// approximates its value at the mean k_ij of both. The column is then completed with fill_from_diagonal and priced exactly.
+/// As the aggregated objective does not bound the slave objective, the full grb_slave (exact) is solved whenever the
+/// compact model finds no column above threshold, so column generation still terminates with a proven optimum.
+class grb_diagonal_slave : public slave_problem
+{
+  public:
+    grb_diagonal_slave(GRBEnv* e,
+                       double element_pitch_in_tacts,
+                       std::optional<double> slavestop,
+                       unsigned offset,
+                       std::optional<double> horizontal_roi_start,
+                       std::optional<double> horizontal_roi_end,
+                       double threshold,
+                       std::ostream& output,
+                       grb_resettable_callback* grb_callback,
+                       bool verbose);
+
+    double element_pitch_in_tacts;
+    std::optional<double> slavestop;
+    unsigned offset;
+    std::optional<double> horizontal_roi_start;
+    std::optional<double> horizontal_roi_end;
+    /// Columns of the compact model with a reduced cost below threshold are replaced by a run of exact.
+    double threshold;
+    std::ostream& output;
+    bool verbose;
+    bool generated = false;
+
+    /// Binaries b_iik.
+    diagonal_arr<proxy_arr<GRBVar>> vars_proxy;
+    /// Diameters d_ii.
+    diagonal_arr<arr_2d<proxy_arr, GRBVar>, 0> diameter_vars_proxy;
+    arr_1d<proxy_arr, GRBVar> squared_vars_proxy;
+    GRBVar representant_x;
+    GRBModel model;
+
+    /// The full formulation, solved when the compact one finds no improving column.
+    grb_slave exact;
+
+    /// Number of runs answered by the compact model, the others were answered by exact.
+    unsigned compact_columns = 0;
+
+    void run(proxy_arr<double>& f, columns& vars) override;
+    void add_solution_start_hints(size size,
+                                  std::vector<time_of_flight>& hints) override;
+
+    /// The aggregated objective coefficient of b_iik.
+    static double aggregated_objective(proxy_arr<double>& f,
+                                       unsigned i,
+                                       unsigned k);
+
+  protected:
+    /// Generates the compact model (without the objective).
+    void generate(size size);
+
+    variables<GRBVar> variables();
+    distance_mapping mapping();
+};
+
+#endif
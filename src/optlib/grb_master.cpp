@@ -18,12 +18,24 @@ grb_master::solve_reduced_problem(
           measurement.dim1, measurement.dim2, measurement.dim3);
         neg_slack_var = new proxy_arr<GRBVar>(
           measurement.dim1, measurement.dim2, measurement.dim3);
+        constraint_var = new proxy_arr<GRBConstr>(
+          measurement.dim1, measurement.dim2, measurement.dim3);
         this->set_start_variables(elements, measurement, reference_signal);
         started = true;
     }
+    if (warm_start_primal) {
+        apply_warm_start(measurement, reference_signal);
+    }
 
+    const adaptive_solver::context context = removed_since_solve
+                                               ? adaptive_solver::AFTER_CLEAN
+                                               : adaptive_solver::AFTER_ADD;
+    std::optional<solver> method = enforce_particular_solver;
     if (enforce_particular_solver) {
         model->set(GRB_IntParam_Method, *enforce_particular_solver);
+    } else if (adaptive) {
+        method = adaptive->next(context);
+        model->set(GRB_IntParam_Method, *method);
     }
 
     try {
@@ -31,23 +43,64 @@ grb_master::solve_reduced_problem(
     } catch (std::exception& e) {
         std::cerr << e.what() << std::endl;
     }
-    double* dual = model->get(GRB_DoubleAttr_Pi,
-                              model->getConstrs(),
-                              model->get(GRB_IntAttr_NumConstrs));
+
+    // enforced solves are not timed, the initial solve is not a re-solve.
+    if (adaptive && !enforce_particular_solver) {
+        adaptive->record(
+          context, *method, model->get(GRB_DoubleAttr_Runtime));
+    }
+
     get_primal(name2amplitude);
+    if (lazy_rows) {
+        unsigned added = 0, rounds = 0;
+        while (const unsigned violated =
+                 add_violated_rows(measurement, reference_signal)) {
+            added += violated;
+            rounds++;
+            try {
+                model->optimize();
+            } catch (std::exception& e) {
+                std::cerr << e.what() << std::endl;
+            }
+            get_primal(name2amplitude);
+        }
+        if (verbose && added > 0) {
+            output << "Added " << added << " rows in " << rounds
+                   << " rounds, master has " << active_rows.size() << " of "
+                   << constraints << " rows." << std::endl;
+        }
+    }
+    removed_since_solve = false;
+
+    // rows that are not in the model have zero duals.
+    if (active_rows.size() == constraints) {
+        std::unique_ptr<double[]> dual(
+          model->get(GRB_DoubleAttr_Pi, constraint_var->data, constraints));
+        std::copy(dual.get(), dual.get() + out.values.size(), out.values.data);
+    } else if (!active_rows.empty()) {
+        std::vector<GRBConstr> active(active_rows.size());
+        for (unsigned r = 0; r < active_rows.size(); r++) {
+            active[r] = constraint_var->data[active_rows[r]];
+        }
+        std::unique_ptr<double[]> dual(
+          model->get(GRB_DoubleAttr_Pi, active.data(), active.size()));
+        std::fill(out.values.begin(), out.values.end(), 0.0);
+        for (unsigned r = 0; r < active_rows.size(); r++) {
+            out.values.data[active_rows[r]] = dual[r];
+        }
+    } else {
+        std::fill(out.values.begin(), out.values.end(), 0.0);
+    }
 
+    obj = model->get(GRB_DoubleAttr_ObjVal) + inactive_objective;
     out.stats = {
-        model->get(GRB_DoubleAttr_ObjVal),
+        obj,
         model->get(GRB_DoubleAttr_Runtime),
         model->get(GRB_DoubleAttr_NodeCount),
     };
 
-    std::copy(dual, dual + out.values.size(), out.values.data);
-    obj = model->get(GRB_DoubleAttr_ObjVal);
-    delete[] dual;
-
     ///set old value back
-    if (enforce_particular_solver) {
+    if (method) {
         model->set(GRB_IntParam_Method, s);
     }
 }
@@ -74,6 +127,7 @@ grb_master::~grb_master()
     }
     delete pos_slack_var;
     delete neg_slack_var;
+    delete constraint_var;
 };
 
 void
@@ -97,38 +151,163 @@ grb_master::set_start_variables(int elements,
     }
 
     constraints = measurement.size();
+    stop_watch build;
 
-    arr<> objective_coefficient(
-      measurement.dim1, measurement.dim2, measurement.dim3);
-    for (unsigned i = 0; i < measurement.dim1; i++) {
-        for (unsigned j = 0; j < measurement.dim2; j++) {
-            for (unsigned k = 0; k < measurement.dim3; k++) {
-                std::string name;
-                name += std::to_string(i);
-                name += '_';
-                name += std::to_string(j);
-                name += '_';
-                name += std::to_string(k);
-
-                GRBVar pos_slack_ =
-                  this->model->addVar(0.0,          //lower bound
-                                      GRB_INFINITY, //upper bound
-                                      1.0,          //objective value
-                                      GRB_CONTINUOUS,
-                                      "pos_slack_" + name);
-                GRBVar neg_slack_ =
-                  this->model->addVar(0.0,          //lower bound
-                                      GRB_INFINITY, //upper bound
-                                      1.0,          //objective value
-                                      GRB_CONTINUOUS,
-                                      "neg_slack_" + name);
-                GRBLinExpr e = -pos_slack_ + neg_slack_;
-                this->model->addConstr(e == measurement(i, j, k));
-                pos_slack_var->at(i, j, k) = pos_slack_;
-                neg_slack_var->at(i, j, k) = neg_slack_;
-            }
+    // Silent rows (|measurement| <= lazy_rows) are left out until a column needs them.
+    active_row.assign(constraints, false);
+    active_rows.clear();
+    std::vector<unsigned> start_rows;
+    for (unsigned row = 0; row < constraints; row++) {
+        if (!lazy_rows || std::abs(measurement.data[row]) > *lazy_rows) {
+            start_rows.push_back(row);
+        }
+    }
+    std::vector<GRBLinExpr> lhs(start_rows.size());
+    add_rows(start_rows, measurement, lhs);
+
+    // without columns the residual is the measurement.
+    inactive_residual.assign(measurement.data, measurement.data + constraints);
+    inactive_objective = 0.0;
+    for (unsigned row = 0; row < constraints; row++) {
+        if (!active_row[row]) {
+            inactive_objective += std::abs(inactive_residual[row]);
         }
     }
+
+    build_time = build.elapsed();
+    if (verbose) {
+        output << "Master built in " << build_time << "s." << std::endl;
+    }
+}
+
+void
+grb_master::add_rows(const std::vector<unsigned>& rows,
+                     const arr<>& measurement,
+                     std::vector<GRBLinExpr>& lhs)
+{
+    assert(rows.size() == lhs.size() && "Need one expression per row!");
+    const unsigned count = rows.size();
+    if (count == 0) {
+        return;
+    }
+
+    // All slacks and constraints are created with one call each, names are optional because building them is slow.
+    const std::vector<double> lower(count, 0.0);
+    const std::vector<double> upper(count, GRB_INFINITY);
+    const std::vector<double> objective(count, 1.0);
+    const std::vector<char> types(count, GRB_CONTINUOUS);
+    std::vector<std::string> pos_names, neg_names;
+    if (names) {
+        pos_names.reserve(count);
+        neg_names.reserve(count);
+        for (unsigned row : rows) {
+            const unsigned k = row % measurement_samples;
+            const unsigned j = (row / measurement_samples) % receivers;
+            const unsigned i = row / measurement_samples / receivers;
+            std::string name;
+            name += std::to_string(i);
+            name += '_';
+            name += std::to_string(j);
+            name += '_';
+            name += std::to_string(k);
+            pos_names.push_back("pos_slack_" + name);
+            neg_names.push_back("neg_slack_" + name);
+        }
+    }
+
+    std::unique_ptr<GRBVar[]> pos_slack(
+      model->addVars(lower.data(),
+                     upper.data(),
+                     objective.data(),
+                     types.data(),
+                     names ? pos_names.data() : nullptr,
+                     count));
+    std::unique_ptr<GRBVar[]> neg_slack(
+      model->addVars(lower.data(),
+                     upper.data(),
+                     objective.data(),
+                     types.data(),
+                     names ? neg_names.data() : nullptr,
+                     count));
+
+    std::vector<double> rhs(count);
+    for (unsigned r = 0; r < count; r++) {
+        lhs[r] += -pos_slack[r] + neg_slack[r];
+        rhs[r] = measurement.data[rows[r]];
+    }
+    const std::vector<char> senses(count, GRB_EQUAL);
+
+    std::unique_ptr<GRBConstr[]> constrs(model->addConstrs(
+      lhs.data(), senses.data(), rhs.data(), nullptr, count));
+    for (unsigned r = 0; r < count; r++) {
+        pos_slack_var->data[rows[r]] = pos_slack[r];
+        neg_slack_var->data[rows[r]] = neg_slack[r];
+        constraint_var->data[rows[r]] = constrs[r];
+        active_row[rows[r]] = true;
+        active_rows.push_back(rows[r]);
+    }
+    model->update();
+}
+
+unsigned
+grb_master::add_violated_rows(const arr<>& measurement,
+                              const arr<>& reference_signal)
+{
+    // residual m - Ax of the rows that are not in the model.
+    std::copy(measurement.data,
+              measurement.data + constraints,
+              inactive_residual.begin());
+    auto tof = name2tof.begin();
+    for (unsigned v = 0; v < name2var.size(); v++, tof++) {
+        const double amplitude = name2amplitude[v];
+        if (amplitude <= 0.0) {
+            continue;
+        }
+        for_each_coefficient(
+          *tof, reference_signal, [&](unsigned row, double coefficient) {
+              if (!active_row[row]) {
+                  inactive_residual[row] -= coefficient * amplitude;
+              }
+          });
+    }
+
+    std::vector<unsigned> violated;
+    inactive_objective = 0.0;
+    for (unsigned row = 0; row < constraints; row++) {
+        if (active_row[row]) {
+            continue;
+        }
+        if (std::abs(inactive_residual[row]) > *lazy_rows) {
+            violated.push_back(row);
+        } else {
+            inactive_objective += std::abs(inactive_residual[row]);
+        }
+    }
+    if (violated.empty()) {
+        return 0;
+    }
+
+    // every column of the model gets its coefficients in the new rows, violated is sorted.
+    std::vector<GRBLinExpr> lhs(violated.size());
+    tof = name2tof.begin();
+    for (unsigned v = 0; v < name2var.size(); v++, tof++) {
+        for_each_coefficient(
+          *tof, reference_signal, [&](unsigned row, double coefficient) {
+              if (active_row[row]) {
+                  return;
+              }
+              const auto it =
+                std::lower_bound(violated.begin(), violated.end(), row);
+              if (it != violated.end() && *it == row) {
+                  lhs[it - violated.begin()] += coefficient * name2var[v];
+              }
+          });
+    }
+    add_rows(violated, measurement, lhs);
+    for (unsigned row : violated) {
+        inactive_residual[row] = 0.0;
+    }
+    return violated.size();
 }
 
 void
@@ -136,28 +315,17 @@ grb_master::add_variable(time_of_flight& variable,
                          const arr<>& reference_signal,
                          std::optional<double> warm_start_value)
 {
-    assert((unsigned)model->get(GRB_IntAttr_NumConstrs) == constraints &&
+    assert((unsigned)model->get(GRB_IntAttr_NumConstrs) ==
+             active_rows.size() &&
            "Should be equal!");
     assert(variable.senders == senders && variable.receivers == receivers &&
            "Variable incompatible with model!");
 
+    std::vector<double> coefficients;
+    std::vector<GRBConstr> rows;
+    column_coefficients(variable, reference_signal, coefficients, rows);
     GRBColumn add_me;
-    proxy_arr<GRBConstr> constr_proxy(
-      senders, receivers, measurement_samples, model->getConstrs(), true);
-    for (unsigned i = 0; i < senders; i++) {
-        for (unsigned j = 0; j < receivers; j++) {
-            const int t_helper = (int)offset - (int)variable.at(i, j);
-            for (unsigned k = 0; k < measurement_samples; k++) {
-                const int t = k + t_helper;
-                double x;
-                //add constraint if not null
-                if (t >= 0 && t < (int)reference_signal.dim3 &&
-                    std::abs(x = reference_signal(i, j, t)) > 1e-13) {
-                    add_me.addTerm(x, constr_proxy(i, j, k));
-                }
-            }
-        }
-    }
+    add_me.addTerms(coefficients.data(), rows.data(), coefficients.size());
 
     GRBVar var = model->addVar(
       0.0,          //lower bound
@@ -176,29 +344,128 @@ grb_master::add_variable(time_of_flight& variable,
     name2var.push_back(var);
 }
 
+void
+grb_master::column_coefficients(const time_of_flight& variable,
+                                const arr<>& reference_signal,
+                                std::vector<double>& coefficients,
+                                std::vector<GRBConstr>& rows) const
+{
+    coefficients.clear();
+    rows.clear();
+    for_each_coefficient(
+      variable, reference_signal, [&](unsigned row, double coefficient) {
+          // rows that are not in the model yet get their coefficients when they are added.
+          if (active_row[row]) {
+              coefficients.push_back(coefficient);
+              rows.push_back(constraint_var->data[row]);
+          }
+      });
+}
+
+void
+grb_master::add_variables(
+  std::vector<time_of_flight>& variables,
+  const arr<>& reference_signal,
+  std::optional<std::reference_wrapper<std::vector<double>>> warm_start_values)
+{
+    assert((!warm_start_values ||
+            warm_start_values->get().size() == variables.size()) &&
+           "Need one warm start value per variable!");
+    const unsigned count = variables.size();
+    if (count == 0) {
+        return;
+    }
+    for (auto& variable : variables) {
+        assert(variable.senders == senders && variable.receivers == receivers &&
+               "Variable incompatible with model!");
+    }
+
+    // Only reads the cached constraints, so the columns can be computed independently.
+    std::vector<std::vector<double>> coefficients(count);
+    std::vector<std::vector<GRBConstr>> rows(count);
+    const unsigned threads =
+      std::max(1u, std::min(std::thread::hardware_concurrency(), count));
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            for (unsigned v = t; v < count; v += threads) {
+                column_coefficients(
+                  variables[v], reference_signal, coefficients[v], rows[v]);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::vector<GRBColumn> columns(count);
+    std::vector<std::string> column_names(count);
+    for (unsigned v = 0; v < count; v++) {
+        columns[v].addTerms(
+          coefficients[v].data(), rows[v].data(), coefficients[v].size());
+        //name : v + vec_position
+        column_names[v] = "v" + std::to_string(name2tof.size() + v);
+    }
+
+    const std::vector<double> lower(count, 0.0);
+    const std::vector<double> upper(count, GRB_INFINITY);
+    const std::vector<double> objective(count, 0.0);
+    const std::vector<char> types(count, GRB_CONTINUOUS);
+    std::unique_ptr<GRBVar[]> vars(model->addVars(lower.data(),
+                                                  upper.data(),
+                                                  objective.data(),
+                                                  types.data(),
+                                                  column_names.data(),
+                                                  columns.data(),
+                                                  count));
+
+    if (warm_start_values) {
+        model->set(GRB_DoubleAttr_Start,
+                   vars.get(),
+                   warm_start_values->get().data(),
+                   count);
+    }
+
+    for (unsigned v = 0; v < count; v++) {
+        name2tof.push_back(std::move(variables[v]));
+        name2amplitude.push_back(0.0);
+        name2var.push_back(vars[v]);
+    }
+}
+
 unsigned
 grb_master::clean()
 {
-    unsigned deleted_vars = 0;
+    cleaned.clear();
+    if (name2var.empty()) {
+        return 0;
+    }
+
+    const int n = name2var.size();
+    std::unique_ptr<double[]> values(
+      model->get(GRB_DoubleAttr_X, name2var.data(), n));
+    std::unique_ptr<int[]> basis(
+      model->get(GRB_IntAttr_VBasis, name2var.data(), n));
 
-    auto var = name2var.begin();
+    name2amplitude.clear();
+    unsigned kept = 0;
     auto tof = name2tof.begin();
-    while (var != name2var.end()) {
-        double value = var->get(GRB_DoubleAttr_X);
+    for (int v = 0; v < n; v++) {
         const int basic = 0;
         //do not remove basic variables as they require to start solving the LP from start.
-        if (value < threshold && var->get(GRB_IntAttr_VBasis) != basic) {
-            model->remove(*var);
-            var = name2var.erase(var);
+        if (values[v] < threshold && basis[v] != basic) {
+            model->remove(name2var[v]);
+            cleaned.push_back(std::move(*tof));
             tof = name2tof.erase(tof);
-            deleted_vars++;
         } else {
-            var++;
+            name2var[kept++] = name2var[v];
+            name2amplitude.push_back(values[v]);
             tof++;
         }
     }
-    /// Reconstruct the name2amplitude vector.
-    get_primal(name2amplitude);
+    const unsigned deleted_vars = n - kept;
+    name2var.resize(kept);
+    removed_since_solve = removed_since_solve || deleted_vars > 0;
     return deleted_vars;
 }
 
@@ -206,11 +473,64 @@ void
 grb_master::get_primal(std::vector<double>& primal_values)
 {
     primal_values.clear();
+    if (name2var.empty()) {
+        return;
+    }
+
+    std::unique_ptr<double[]> values(
+      model->get(GRB_DoubleAttr_X, name2var.data(), name2var.size()));
+    primal_values.assign(values.get(), values.get() + name2var.size());
+}
 
-    for (auto& var : name2var) {
-        double value = var.get(GRB_DoubleAttr_X);
-        primal_values.push_back(value);
+void
+grb_master::set_warm_start(const std::vector<double>& primal_values,
+                           const arr<>& duals)
+{
+    assert(primal_values.size() == name2tof.size() &&
+           "Need one warm start value per variable!");
+    warm_start_primal = primal_values;
+    warm_start_duals.assign(duals.begin(), duals.end());
+}
+
+void
+grb_master::apply_warm_start(const arr<>& measurement,
+                             const arr<>& reference_signal)
+{
+    std::vector<double> residual(measurement.begin(), measurement.end());
+    auto value = warm_start_primal->begin();
+    for (const time_of_flight& tof : name2tof) {
+        const double x = *value++;
+        if (x != 0.0) {
+            for_each_coefficient(
+              tof, reference_signal, [&](unsigned row, double coefficient) {
+                  residual[row] -= x * coefficient;
+              });
+        }
+    }
+
+    std::vector<GRBVar> slacks;
+    std::vector<double> slack_values;
+    std::vector<GRBConstr> rows;
+    std::vector<double> row_duals;
+    for (unsigned row : active_rows) {
+        slacks.push_back(pos_slack_var->data[row]);
+        slack_values.push_back(std::max(0.0, -residual[row]));
+        slacks.push_back(neg_slack_var->data[row]);
+        slack_values.push_back(std::max(0.0, residual[row]));
+        rows.push_back(constraint_var->data[row]);
+        row_duals.push_back(warm_start_duals[row]);
     }
+
+    // Gurobi prefers the basis of the last solve over a start vector.
+    model->reset(0);
+    model->set(GRB_DoubleAttr_PStart,
+               name2var.data(),
+               warm_start_primal->data(),
+               name2var.size());
+    model->set(
+      GRB_DoubleAttr_PStart, slacks.data(), slack_values.data(), slacks.size());
+    model->set(GRB_DoubleAttr_DStart, rows.data(), row_duals.data(), rows.size());
+    warm_start_primal.reset();
 }
 
 void
@@ -218,15 +538,36 @@ grb_master::get_primal(std::vector<double>& primal_values,
                        arr<>& pos_slack,
                        arr<>& neg_slack)
 {
+    assert(pos_slack.size() == constraints && neg_slack.size() == constraints &&
+           "Incompatible dimensions!");
+
     // slack
-    for (unsigned i = 0; i < pos_slack.dim1; i++) {
-        for (unsigned j = 0; j < pos_slack.dim2; j++) {
-            for (unsigned k = 0; k < pos_slack.dim3; k++) {
-                pos_slack.at(i, j, k) =
-                  pos_slack_var->at(i, j, k).get(GRB_DoubleAttr_X);
-                neg_slack.at(i, j, k) =
-                  neg_slack_var->at(i, j, k).get(GRB_DoubleAttr_X);
-            }
+    if (active_rows.size() == constraints) {
+        std::unique_ptr<double[]> pos(
+          model->get(GRB_DoubleAttr_X, pos_slack_var->data, constraints));
+        std::unique_ptr<double[]> neg(
+          model->get(GRB_DoubleAttr_X, neg_slack_var->data, constraints));
+        std::copy(pos.get(), pos.get() + constraints, pos_slack.data);
+        std::copy(neg.get(), neg.get() + constraints, neg_slack.data);
+    } else {
+        // the slacks of rows that are not in the model follow from their residual.
+        std::vector<GRBVar> pos_active(active_rows.size());
+        std::vector<GRBVar> neg_active(active_rows.size());
+        for (unsigned r = 0; r < active_rows.size(); r++) {
+            pos_active[r] = pos_slack_var->data[active_rows[r]];
+            neg_active[r] = neg_slack_var->data[active_rows[r]];
+        }
+        std::unique_ptr<double[]> pos(model->get(
+          GRB_DoubleAttr_X, pos_active.data(), pos_active.size()));
+        std::unique_ptr<double[]> neg(model->get(
+          GRB_DoubleAttr_X, neg_active.data(), neg_active.size()));
+        for (unsigned row = 0; row < constraints; row++) {
+            pos_slack.data[row] = std::max(0.0, -inactive_residual[row]);
+            neg_slack.data[row] = std::max(0.0, inactive_residual[row]);
+        }
+        for (unsigned r = 0; r < active_rows.size(); r++) {
+            pos_slack.data[active_rows[r]] = pos[r];
+            neg_slack.data[active_rows[r]] = neg[r];
         }
     }
 
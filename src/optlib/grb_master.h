@@ -1,15 +1,23 @@
 #ifndef GRB_MASTER_H
 #define GRB_MASTER_H
 
+#include "adaptive_solver.h"
 #include "arr.h"
 #include "convolution.h"
 #include "coordinates.h"
 #include "grb_callback.h"
 #include "gurobi_c++.h"
 #include "master.h"
+#include "stop_watch.h"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <list>
+#include <memory>
 #include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 
 /// A master_problem implementation using Gurobi.
 class grb_master : public master_problem
@@ -28,8 +36,11 @@ class grb_master : public master_problem
 
     proxy_arr<GRBVar>* neg_slack_var = nullptr;
 
-    /// Maps variables names (indexes) to their corresponding variables.
-    std::list<GRBVar> name2var;
+    /// The constraints of the measurement, cached so that add_variable and the bulk Pi query do not need getConstrs().
+    proxy_arr<GRBConstr>* constraint_var = nullptr;
+
+    /// Maps variables names (indexes) to their corresponding variables, contiguous for bulk attribute queries.
+    std::vector<GRBVar> name2var;
     bool started;
     unsigned constraints, offset;
 
@@ -40,6 +51,30 @@ class grb_master : public master_problem
     /// Masterclean : variables having an value < threshold are automatically removed from the master.
     double threshold;
 
+    /// Give the slack variables names (only useful when debugging the model).
+    bool names = true;
+    /// Wallclock time needed by set_start_variables.
+    double build_time = 0.0;
+
+    /// Chooses the method of every solve that does not enforce a particular solver, s is used when not set.
+    std::optional<adaptive_solver> adaptive;
+    /// True when clean removed variables since the last solve.
+    bool removed_since_solve = false;
+
+    /// @brief Row generation : rows with |measurement| <= lazy_rows start outside of the model.
+    ///
+    /// After every solve the rows outside of the model whose residual exceeds lazy_rows are added and the master is solved again.
+    /// Rows outside of the model have zero duals, their residual is added to the objective.
+    std::optional<double> lazy_rows;
+    /// True for rows (flattened measurement index) that are in the model.
+    std::vector<bool> active_row;
+    /// The rows in the model, in the order they were added.
+    std::vector<unsigned> active_rows;
+    /// The residual m - Ax of the rows that are not in the model (from the last check).
+    std::vector<double> inactive_residual;
+    /// Sum of the absolute residuals of the rows that are not in the model.
+    double inactive_objective = 0.0;
+
     virtual void solve_reduced_problem(
       int elements,
       unsigned offset,
@@ -53,6 +88,13 @@ class grb_master : public master_problem
                               const arr<>& reference_signal,
                               std::optional<double> warm_start_value) override;
 
+    /// Builds the coefficients of all columns in parallel and adds them with one addVars call.
+    virtual void add_variables(
+      std::vector<time_of_flight>& variables,
+      const arr<>& reference_signal,
+      std::optional<std::reference_wrapper<std::vector<double>>>
+        warm_start_values) override;
+
     virtual void get_primal(std::vector<double>& primal_values) override;
 
     virtual void get_primal(std::vector<double>& primal_values,
@@ -61,12 +103,70 @@ class grb_master : public master_problem
 
     virtual unsigned clean() override;
 
+    /// Sets PStart of the variables and slacks and DStart of the rows for the next solve, which ignores the last basis.
+    virtual void set_warm_start(const std::vector<double>& primal_values,
+                                const arr<>& duals) override;
+
+    /// The warm start of the next solve.
+    std::optional<std::vector<double>> warm_start_primal;
+    std::vector<double> warm_start_duals;
+
+    /// Passes the warm start to Gurobi, the slacks follow from the residual of the warm start.
+    void apply_warm_start(const arr<>& measurement,
+                          const arr<>& reference_signal);
+
+    /// Computes the nonzero coefficients (and their constraints) of the column of variable.
+    void column_coefficients(const time_of_flight& variable,
+                             const arr<>& reference_signal,
+                             std::vector<double>& coefficients,
+                             std::vector<GRBConstr>& rows) const;
+
+    /// Calls f(row, coefficient) for every nonzero coefficient of the column of variable (rows are flattened measurement indexes).
+    template<typename F>
+    void for_each_coefficient(const time_of_flight& variable,
+                              const arr<>& reference_signal,
+                              F f) const;
+
+    /// Adds the rows (sorted flattened measurement indexes) with their slacks, lhs contains the column terms of every row.
+    void add_rows(const std::vector<unsigned>& rows,
+                  const arr<>& measurement,
+                  std::vector<GRBLinExpr>& lhs);
+
+    /// Adds the rows outside of the model that are violated by the last solution, returns their number.
+    unsigned add_violated_rows(const arr<>& measurement,
+                               const arr<>& reference_signal);
+
     /// Generate some columns, will be called automatically on start.
     virtual void set_start_variables(int elements,
                                      arr<>& measurement,
                                      arr<>& reference_signal);
 };
 
+template<typename F>
+void
+grb_master::for_each_coefficient(const time_of_flight& variable,
+                                 const arr<>& reference_signal,
+                                 F f) const
+{
+    for (unsigned i = 0; i < senders; i++) {
+        for (unsigned j = 0; j < receivers; j++) {
+            // The column is only nonzero where the shifted reference overlaps the measurement.
+            const int t_helper = (int)offset - (int)variable.at(i, j);
+            const int k_begin = std::max(0, -t_helper);
+            const int k_end = std::min((int)measurement_samples,
+                                       (int)reference_signal.dim3 - t_helper);
+            const unsigned row = (i * receivers + j) * measurement_samples;
+            for (int k = k_begin; k < k_end; k++) {
+                const double x = reference_signal(i, j, k + t_helper);
+                //add constraint if not null
+                if (std::abs(x) > 1e-13) {
+                    f(row + k, x);
+                }
+            }
+        }
+    }
+}
+
 /// A grb_master implementation that calls std::this_thread::yield() to become slower.
 class slow_grb_master : public grb_master
 {
@@ -2,14 +2,32 @@
 
 grb_multiple_slave_async::constraint_pool_adder::constraint_pool_adder(
   constraint_pool& pool,
-  unsigned& slave_id)
+  unsigned& slave_id,
+  std::atomic<unsigned>& found,
+  strip_decomposition* strips)
   : pool(pool)
   , slave_id(slave_id)
+  , found(found)
+  , strips(strips)
 {}
 
 void
 grb_multiple_slave_async::constraint_pool_adder::operator()(column&& c)
 {
+    found++;
+    if (strips) {
+        if (c.optimality != column::NON_OPTIMAL) {
+            // only optimal for the strip: wait for the other strips of the same dual.
+            if (std::optional<column> best =
+                  strips->finish(std::move(c), slave_id)) {
+                pool.add(std::move(*best), slave_id);
+            }
+            return;
+        }
+        if (c.tof.representant_x) {
+            strips->record(*c.tof.representant_x);
+        }
+    }
     pool.add(std::move(c), slave_id);
 }
 
@@ -27,20 +45,31 @@ grb_multiple_slave_async::grb_multiple_slave_async(
   slave_output_settings& can_print,
   slave_cut_options slave_cuts,
   std::string prefix_for_output,
-  slave_callback_options options)
+  slave_callback_options options,
+  bool use_portfolio,
+  std::optional<double> strip_overlap)
 
   : output(output)
   , verbose(verbose)
   , max_parallel_slaves(max_parallel_slaves)
   , threshold(slave_threshold)
+  , element_pitch_in_tacts(element_pitch_in_tacts)
+  , offset(offset)
+  , horizontal_roi_start(horizontal_roi_start)
+  , horizontal_roi_end(horizontal_roi_end)
   , pool(pool)
   , next_slave_id(1)
   , can_print(can_print)
 {
     assert(threshold >= 0 && "Threshold should be >= 0");
+    if (strip_overlap) {
+        decomposition = std::make_unique<strip_decomposition>(
+          max_parallel_slaves, *strip_overlap);
+    }
 
     for (unsigned i = 0; i < max_parallel_slaves; i++) {
         slave_ids.push_back(0);
+        slots.emplace_back();
         slave_output.emplace_back();
         slave_pool.emplace_back(element_pitch_in_tacts,
                                 slavestop,
@@ -52,22 +81,33 @@ grb_multiple_slave_async::grb_multiple_slave_async(
                                 slave_output.back().output,
                                 slave_output.back().lock,
                                 verbose,
-                                constraint_pool_adder(pool, slave_ids.back()),
+                                constraint_pool_adder(pool,
+                                                      slave_ids.back(),
+                                                      slots.back().found,
+                                                      decomposition.get()),
                                 threshold,
                                 slave_cuts,
                                 prefix_for_output,
                                 options);
 
+        slave_pool.back().restrict_to_roi = decomposition != nullptr;
+
         // set categories :for 4 we have one with 25%, one with 50% and 2 unbounded.
-        if (i < std::log2(max_parallel_slaves)) {
+        if (!use_portfolio && !decomposition &&
+            i < std::log2(max_parallel_slaves)) {
             double max_allowed_gap = (double)(1 << i) / max_parallel_slaves;
             if (max_allowed_gap < 1.0) {
                 slave_pool.back().max_allowed_gap = max_allowed_gap;
             }
         }
     }
+    if (use_portfolio && !decomposition) {
+        portfolio.emplace(
+          slave_portfolio::default_configurations(slave_cuts, options));
+    }
     current_slave_id = slave_ids.begin();
     current_slave = slave_pool.begin();
+    current_slot = slots.begin();
     printer = std::thread([&]() {
         while (alive()) {
             print(false);
@@ -94,8 +134,41 @@ grb_multiple_slave_async::next_slave()
     if (++current_slave == slave_pool.end()) {
         current_slave = slave_pool.begin();
         current_slave_id = slave_ids.begin();
+        current_slot = slots.begin();
     } else {
         ++current_slave_id;
+        ++current_slot;
+    }
+}
+
+void
+grb_multiple_slave_async::reconfigure_current_slave()
+{
+    current_slave->cancel();
+    if (current_slot->configuration) {
+        portfolio->finish(*current_slot->configuration,
+                          current_slot->found,
+                          current_slave->model.get(GRB_DoubleAttr_Runtime));
+    }
+    const unsigned c = portfolio->start();
+    const slave_configuration& configuration = portfolio->configurations[c];
+    current_slot->configuration = c;
+    current_slot->found = 0;
+
+    current_slave->max_allowed_gap = configuration.max_allowed_gap;
+    current_slave->model.set(GRB_IntParam_Seed, configuration.seed);
+    auto* cb = static_cast<grb_slave_async_cb<slave_type>*>(
+      current_slave->grb_callback);
+    cb->slave_cuts = configuration.cuts;
+    cb->options = static_cast<slave_callback_options>(configuration.options);
+
+    if (verbose) {
+        const slave_portfolio::performance& p = portfolio->stats[c];
+        output << " ==== Portfolio : configuration " << c << " (cuts "
+               << configuration.cuts << ", options " << configuration.options
+               << ", gap " << configuration.max_allowed_gap.value_or(1.0)
+               << ") with " << p.columns << " columns in " << p.seconds
+               << " seconds ====\n";
     }
 }
 
@@ -107,29 +180,116 @@ grb_multiple_slave_async::cancel()
     }
 }
 
+void
+grb_multiple_slave_async::run_strips(proxy_arr<double>& f)
+{
+    // the strips of one dual only prove optimality together, so all of them restart.
+    cancel();
+    if (!decomposition->initialised()) {
+        // same default roi as grb_slave::generate.
+        const double max_distance = f.dim3 + offset;
+        decomposition->initialise(
+          horizontal_roi_start.value_or(-max_distance),
+          horizontal_roi_end.value_or(max_distance),
+          0.0,
+          2.0 * (f.dim1 - 1) * element_pitch_in_tacts);
+    } else {
+        decomposition->rebalance();
+    }
+
+    const unsigned generation = next_slave_id++;
+    pool.set_current_slave_id(generation);
+    decomposition->start(generation);
+
+    unsigned s = 0;
+    auto id = slave_ids.begin();
+    for (slave_type& slave : slave_pool) {
+        *id++ = generation;
+        const std::pair<double, double> strip = decomposition->strip(s++);
+        slave.set_horizontal_roi(strip.first, strip.second);
+        slave.run_async(f);
+    }
+
+    if (verbose) {
+        output << " ==== Strip boundaries :";
+        for (double b : decomposition->boundaries()) {
+            output << " " << b;
+        }
+        output << " ====\n";
+    }
+}
+
 void
 grb_multiple_slave_async::run_async(proxy_arr<double>& f)
 {
-    while (!current_slave->ready()) {
+    if (decomposition) {
+        run_strips(f);
+        return;
+    }
+
+    while (!current_slave->ready() &&
+           !(portfolio && current_slot->configuration &&
+             portfolio->killed(*current_slot->configuration))) {
         next_slave();
     }
+    if (portfolio) {
+        reconfigure_current_slave();
+    }
 
     *current_slave_id = next_slave_id++;
     pool.set_current_slave_id(*current_slave_id);
 
     current_slave->run_async(f);
     next_slave();
+    if (max_dual_age) {
+        publish_dual(f, next_slave_id - 1);
+    }
 
     unsigned total_consumed, consumed_from_old_slave, actual_unconsumed;
     pool.get_statistics(
       total_consumed, consumed_from_old_slave, actual_unconsumed);
+    unsigned evictions, hits;
+    pool.get_eviction_statistics(evictions, hits);
 
     if (verbose) {
         output << " ==== Current Pool-statistics :" << consumed_from_old_slave
                << "/" << total_consumed
                << " old-slave-constraints separated master and actual size :"
-               << actual_unconsumed << " ====\n";
+               << actual_unconsumed << ", evicted " << evictions
+               << ", hits " << hits << " ====\n";
+    }
+}
+
+void
+grb_multiple_slave_async::publish_dual(proxy_arr<double>& f,
+                                       unsigned generation)
+{
+    // one round over all slaves ends on the current slave again.
+    for (unsigned s = 0; s < slave_pool.size(); s++, next_slave()) {
+        if (*current_slave_id == generation || !current_slave->ready()) {
+            continue;
+        }
+        const bool idle =
+          current_slave->model.get(GRB_IntAttr_Status) != GRB_INPROGRESS;
+        const bool stale = generation - *current_slave_id >= *max_dual_age;
+        if (idle || stale) {
+            if (portfolio) {
+                reconfigure_current_slave();
+            }
+            *current_slave_id = generation;
+            current_slave->run_async(f);
+        }
+    }
+}
+
+double
+grb_multiple_slave_async::busy_time()
+{
+    double busy = 0.0;
+    for (slave_type& slave : slave_pool) {
+        busy += slave.busy_seconds;
     }
+    return busy;
 }
 
 bool
@@ -5,7 +5,11 @@
 #include "grb_slave.h"
 #include "grb_slave_async.h"
 #include "slave_output_settings.h"
+#include "slave_portfolio.h"
+#include "strip_decomposition.h"
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -23,7 +27,14 @@ class grb_multiple_slave_async
       public:
         constraint_pool& pool;
         unsigned& slave_id;
-        constraint_pool_adder(constraint_pool& pool, unsigned& slave_id);
+        /// Counts the columns of the current run for the portfolio.
+        std::atomic<unsigned>& found;
+        /// Holds back the final columns of strip slaves, nullptr without decomposition.
+        strip_decomposition* strips;
+        constraint_pool_adder(constraint_pool& pool,
+                              unsigned& slave_id,
+                              std::atomic<unsigned>& found,
+                              strip_decomposition* strips);
 
         void operator()(column&& c);
     };
@@ -54,7 +65,9 @@ class grb_multiple_slave_async
                              slave_output_settings& can_print,
                              slave_cut_options slave_cuts,
                              std::string prefix_for_output,
-                             slave_callback_options options);
+                             slave_callback_options options,
+                             bool use_portfolio = false,
+                             std::optional<double> strip_overlap = std::nullopt);
 
     ~grb_multiple_slave_async() override;
 
@@ -66,6 +79,10 @@ class grb_multiple_slave_async
     std::list<unsigned>::iterator current_slave_id;
     /// Used to filter non-optimal slave solutions out. Should be > 0.
     double threshold;
+    double element_pitch_in_tacts;
+    unsigned offset;
+    std::optional<double> horizontal_roi_start;
+    std::optional<double> horizontal_roi_end;
 
     constraint_pool& pool;
 
@@ -74,11 +91,48 @@ class grb_multiple_slave_async
     std::list<unsigned> slave_ids;
     std::list<locked_ostream> slave_output;
 
+    /// The run of a slave as seen by the portfolio.
+    struct portfolio_slot
+    {
+        /// Columns found in the current run.
+        std::atomic<unsigned> found{ 0 };
+        /// Configuration of the current run, nullopt before the first run.
+        std::optional<unsigned> configuration;
+    };
+    std::list<portfolio_slot> slots;
+    /// Slot of the slave that is next on worklist.
+    std::list<portfolio_slot>::iterator current_slot;
+
+    /// @brief Assigns the configurations to the slaves, the hard-coded gap categories are used without it.
+    ///
+    /// Slaves of killed configurations can be interrupted at any time.
+    std::optional<slave_portfolio> portfolio;
+    /// Records the last run of the current slave and applies the next configuration to it.
+    void reconfigure_current_slave();
+
+    /// @brief Gives every slave its own strip of the horizontal ROI, cf. strip_decomposition.
+    ///
+    /// All slaves are restarted together on every dual, the portfolio is not used then.
+    std::unique_ptr<strip_decomposition> decomposition;
+    /// Rebalances the strips and restarts all slaves on f.
+    void run_strips(proxy_arr<double>& f);
+
+    /// @brief Pipelined mode : every new dual is also published to the other slaves, unset disables it.
+    ///
+    /// Idle slaves are always restarted on the new dual, running slaves only when they are ready and their dual is
+    /// max_dual_age or more duals old. Gurobi can not change the objective of a running optimisation, so publishing
+    /// means restarting.
+    std::optional<unsigned> max_dual_age;
+    /// Restarts the idle and stale slaves on f (the dual with id generation), cf. max_dual_age.
+    void publish_dual(proxy_arr<double>& f, unsigned generation);
+
     unsigned next_slave_id;
     /// Modifies the iterators to get the next slave.
     void next_slave();
 
     void run(proxy_arr<double>& f, columns& columns) override;
+    /// Sum of the busy times of the async slaves.
+    double busy_time() override;
     void add_solution_start_hints(size size,
                                   std::vector<time_of_flight>& starts) override;
     void cancel() override;
@@ -124,6 +124,10 @@ grb_slave::generate(size f)
       model.addVars(symmetric_arr<proxy_arr<GRBVar>>::size(f), GRB_BINARY),
       true);
     vars_objective.realloca(f.dim1, f.dim2, f.dim3);
+    // All binaries start with a zero objective coefficient.
+    objective.assign(vars_proxy.size(), 0.0);
+    next_objective.assign(vars_proxy.size(), 0.0);
+    model.set(GRB_IntAttr_ModelSense, GRB_MAXIMIZE);
     diameter_vars_proxy.realloca(
       f.dim1,
       f.dim2,
@@ -159,18 +163,38 @@ grb_slave::generate(size f)
     generated = true;
 }
 
+void
+grb_slave::set_horizontal_roi(std::optional<double> start,
+                              std::optional<double> end)
+{
+    horizontal_roi_start = start;
+    horizontal_roi_end = end;
+    if (!generated) {
+        return;
+    }
+    const int max_distance = distance_mapping(vars_proxy.dim3);
+    representant_x.set(GRB_DoubleAttr_LB, start.value_or(-max_distance));
+    representant_x.set(GRB_DoubleAttr_UB, end.value_or(max_distance));
+    if (presolve || restrict_to_roi) {
+        fix_geometrically_impossible();
+    }
+    // the incumbent may lie outside of the new roi.
+    incumbent.clear();
+}
+
 void
 grb_slave::update_objective(proxy_arr<double>& f)
 {
     assert(f.dim1 == vars_proxy.dim1 && f.dim2 == vars_proxy.dim2 &&
            f.dim3 == vars_proxy.dim3);
 
-    GRBLinExpr obj = 0;
+    // (i, j, k) and (j, i, k) share one binary, so its coefficient is the sum of both.
+    std::fill(next_objective.begin(), next_objective.end(), 0.0);
     for (unsigned i = 0; i < f.dim1; i++) {
         for (unsigned j = 0; j < f.dim2; j++) {
             for (unsigned k = 0; k < f.dim3; k++) {
                 if (std::fabs(f(i, j, k)) > 1e-10) {
-                    obj += f(i, j, k) * vars_proxy.at(i, j, k);
+                    next_objective[vars_proxy.index(i, j, k)] += f(i, j, k);
                     vars_objective(i, j, k) = f(i, j, k);
                 } else {
                     vars_objective(i, j, k) = 0.0;
@@ -179,7 +203,113 @@ grb_slave::update_objective(proxy_arr<double>& f)
         }
     }
 
-    model.setObjective(obj, GRB_MAXIMIZE);
+    // Only the coefficients that changed since the last iteration are sent to Gurobi, with one call.
+    std::vector<GRBVar> changed_vars;
+    std::vector<double> changed_values;
+    for (unsigned v = 0; v < next_objective.size(); v++) {
+        if (next_objective[v] != objective[v]) {
+            changed_vars.push_back(vars_proxy.data[v]);
+            changed_values.push_back(next_objective[v]);
+        }
+    }
+    if (!changed_vars.empty()) {
+        model.set(GRB_DoubleAttr_Obj,
+                  changed_vars.data(),
+                  changed_values.data(),
+                  changed_vars.size());
+    }
+    std::swap(objective, next_objective);
+}
+
+void
+grb_slave::fix_geometrically_impossible()
+{
+    const unsigned samples = vars_proxy.dim3;
+    // the bounds of representant_x.
+    const double max_distance = distance_mapping(samples);
+    slave_constraint_generator scg{
+        vars_proxy,
+        mapping(),
+        element_pitch_in_tacts,
+    };
+    k_range = scg.reachable_k_ranges(horizontal_roi_start.value_or(-max_distance),
+                                     horizontal_roi_end.value_or(max_distance));
+
+    std::vector<char> fix(vars_proxy.size(), false);
+    for (unsigned pair = 0; pair < k_range.size(); pair++) {
+        for (unsigned k = 0; k < samples; k++) {
+            fix[pair * samples + k] =
+              k < k_range[pair].first || k > k_range[pair].second;
+        }
+    }
+
+    // the first call starts with all binaries free, later calls (new roi) release the binaries fixed before.
+    if (fixed.size() != vars_proxy.size()) {
+        fixed.assign(vars_proxy.size(), false);
+    }
+    set_fixed(fix);
+}
+
+void
+grb_slave::fix_by_objective()
+{
+    const unsigned samples = vars_proxy.dim3;
+    const unsigned pairs = k_range.size();
+    std::vector<char> fix(vars_proxy.size(), false);
+    for (unsigned p = 0; p < pairs; p++) {
+        for (unsigned k = 0; k < samples; k++) {
+            fix[p * samples + k] = k < k_range[p].first || k > k_range[p].second;
+        }
+    }
+
+    bool incumbent_feasible = incumbent.size() == pairs;
+    for (unsigned p = 0; incumbent_feasible && p < pairs; p++) {
+        incumbent_feasible = incumbent[p] >= k_range[p].first &&
+                             incumbent[p] <= k_range[p].second;
+    }
+
+    if (incumbent_feasible) {
+        // upper bound : every pair takes its best binary, lower bound : the incumbent with the current objective.
+        std::vector<double> best(pairs, -GRB_INFINITY);
+        double upper = 0.0, lower = 0.0;
+        for (unsigned p = 0; p < pairs; p++) {
+            for (unsigned k = k_range[p].first; k <= k_range[p].second; k++) {
+                best[p] = std::max(best[p], objective[p * samples + k]);
+            }
+            upper += best[p];
+            lower += objective[p * samples + incumbent[p]];
+        }
+        const double tolerance = 1e-9 * std::max(1.0, std::fabs(lower));
+        for (unsigned p = 0; p < pairs; p++) {
+            for (unsigned k = k_range[p].first; k <= k_range[p].second; k++) {
+                const unsigned v = p * samples + k;
+                fix[v] = upper - best[p] + objective[v] < lower - tolerance;
+            }
+        }
+    }
+    set_fixed(fix);
+}
+
+void
+grb_slave::set_fixed(const std::vector<char>& fix)
+{
+    std::vector<GRBVar> changed_vars;
+    std::vector<double> changed_bounds;
+    fixed_binaries = 0;
+    for (unsigned v = 0; v < fix.size(); v++) {
+        fixed_binaries += fix[v];
+        if (fix[v] != fixed[v]) {
+            changed_vars.push_back(vars_proxy.data[v]);
+            changed_bounds.push_back(fix[v] ? 0.0 : 1.0);
+            fixed[v] = fix[v];
+        }
+    }
+    if (!changed_vars.empty()) {
+        model.set(GRB_DoubleAttr_UB,
+                  changed_vars.data(),
+                  changed_bounds.data(),
+                  changed_vars.size());
+    }
 }
 
 void
@@ -191,6 +321,16 @@ grb_slave::prepare_for_solving(proxy_arr<double>& f)
         this->generate(f);
         this->update_objective(f);
         model.write("myslave.lp");
+        if (presolve || restrict_to_roi) {
+            fix_geometrically_impossible();
+        }
+    }
+    if (presolve) {
+        fix_by_objective();
+        if (verbose) {
+            output << "Presolve fixed " << fixed_binaries << " of "
+                   << vars_proxy.size() << " binaries." << std::endl;
+        }
     }
     if (grb_callback) {
         grb_callback->reset();
@@ -311,6 +451,20 @@ grb_slave::get_results(columns& columns)
       representant_x.get(GRB_DoubleAttr_X),
       tof);
 
+    // the result is the incumbent of the next presolve.
+    incumbent.resize(k_range.size());
+    for (unsigned i = 0; i < vars_proxy.dim1 && !incumbent.empty(); i++) {
+        for (unsigned j = i; j < vars_proxy.dim2; j++) {
+            const std::optional<unsigned> k =
+              revert_distance_mapping(tof.at(i, j));
+            if (!k) {
+                incumbent.clear();
+                break;
+            }
+            incumbent[vars_proxy.index(i, j, 0) / vars_proxy.dim3] = *k;
+        }
+    }
+
     columns.push_back({ std::move(tof),
                         {
                           obj,
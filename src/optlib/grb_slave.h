@@ -19,6 +19,7 @@
 #include <optional>
 #include <sstream>
 #include <tuple>
+#include <vector>
 
 /// A slave_problem implementation using Gurobi.
 class grb_slave : public slave_problem
@@ -26,9 +27,21 @@ class grb_slave : public slave_problem
   protected:
     /// Generates the problem (without the objective).
     void generate(size size);
-    /// Generates the objective.
+    /// Sets the objective coefficients of the binaries that changed since the last call with one attribute call.
     void update_objective(proxy_arr<double>& f);
 
+    /// Objective coefficient of every binary (same layout as vars_proxy.data) as set in the model.
+    std::vector<double> objective;
+    /// Buffer for the coefficients of the next objective.
+    std::vector<double> next_objective;
+
+    /// Computes k_range from the constraints of the model and fixes all binaries outside of it.
+    void fix_geometrically_impossible();
+    /// Fixes the binaries that cannot improve on the incumbent under the current objective (and frees the others).
+    void fix_by_objective();
+    /// Sets the upper bound of every binary whose fixed-state differs from fix with one attribute call.
+    void set_fixed(const std::vector<char>& fix);
+
   public:
     double element_pitch_in_tacts;
     const double squared_pitch;
@@ -51,6 +64,29 @@ class grb_slave : public slave_problem
 
     grb_resettable_callback* grb_callback;
 
+    /// @brief Presolve : fixes binaries that cannot be part of an optimal column before every solve.
+    ///
+    /// Binaries outside of the range of their sender-receiver-pair that the constraints allow
+    /// (slave_constraint_generator::reachable_k_ranges) are fixed once, the others are fixed per iteration if even the
+    /// best choice for all other pairs can not beat the last result (the incumbent). Neither removes a feasible solution
+    /// that beats the incumbent, so the reported best_objective_bound stays a bound of the whole slave.
+    bool presolve = false;
+    /// Fixes the binaries outside of k_range whenever the horizontal roi changes, also without presolve. Used by the
+    /// strip slaves of grb_multiple_slave_async, so that every strip solves a MIP of its own strip only.
+    bool restrict_to_roi = false;
+    /// Smallest and largest possible k of every sender-receiver-pair i <= j (same order as vars_proxy).
+    std::vector<std::pair<unsigned, unsigned>> k_range;
+    /// True for binaries whose upper bound is 0 in the model (same layout as vars_proxy.data).
+    std::vector<char> fixed;
+    /// k of every sender-receiver-pair in the last result, empty before the first result.
+    std::vector<unsigned> incumbent;
+    /// Number of binaries fixed for the last solve.
+    unsigned fixed_binaries = 0;
+
+    /// Restricts the representant x to [start, end] (nullopt for unbounded), recomputes k_range when the model already exists.
+    void set_horizontal_roi(std::optional<double> start,
+                            std::optional<double> end);
+
     variables<GRBVar> variables();
 
     distance_mapping mapping();
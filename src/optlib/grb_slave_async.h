@@ -1,6 +1,8 @@
 #ifndef GRB_SLAVE_ASYNC_H
 #define GRB_SLAVE_ASYNC_H
 #include "slave_problem.h"
+#include "stop_watch.h"
+#include <atomic>
 #include <thread>
 
 /// Used to find new columns asynchronously.
@@ -38,6 +40,9 @@ class grb_slave_async
     /// A thread because gurobi misses a optimisation-ended-callback.
     std::thread thread;
 
+    /// Seconds spent in finished (or cancelled) optimisations, only written by thread.
+    std::atomic<double> busy_seconds{ 0.0 };
+
     ///@brief Returns the current MIPGap, because the Gurobi MIPGap attribute throws errors when optimizing asynchronously.
     ///
     /// GRB does not throw exceptions when querying the values needed to compute the mip-gap, so we get them and compute it manually.
@@ -97,8 +102,10 @@ grb_slave_async<Callback>::run_async(proxy_arr<double>& f)
 
     thread = std::thread(
       [](grb_slave_async<Callback>* self) {
+          stop_watch busy;
           self->model.optimizeasync();
           self->model.sync();
+          self->busy_seconds = self->busy_seconds + busy.elapsed();
           // make sure it is not infeasible.
           assert_that(assert_feasibility(self->model), "Infeasible slave!");
 
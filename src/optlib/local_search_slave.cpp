@@ -0,0 +1,190 @@
+#include "local_search_slave.h"
+
+local_search_slave::local_search_slave(double element_pitch_in_tacts,
+                                       unsigned radius,
+                                       unsigned max_steps,
+                                       unsigned offset,
+                                       double threshold,
+                                       callback solution_callback)
+  : n(element_pitch_in_tacts)
+  , radius(radius)
+  , max_steps(max_steps)
+  , offset(offset)
+  , threshold(threshold)
+  , solution_callback(solution_callback)
+{}
+
+local_search_slave::~local_search_slave()
+{
+    cancel();
+}
+
+void
+local_search_slave::set_centres(const std::list<time_of_flight>& variables,
+                                const std::vector<double>& amplitudes)
+{
+    cancel();
+    centres.clear();
+    unsigned v = 0;
+    for (const time_of_flight& tof : variables) {
+        if (v < amplitudes.size() && amplitudes[v] > 0.0) {
+            centres.emplace_back(tof.senders, tof.receivers, tof.representant_x);
+            std::copy(tof.begin(), tof.end(), centres.back().begin());
+        }
+        v++;
+    }
+}
+
+unsigned
+local_search_slave::centres_size() const
+{
+    return centres.size();
+}
+
+void
+local_search_slave::price(const arr_2d<arr, unsigned>& batch,
+                          unsigned candidates,
+                          std::vector<double>& costs) const
+{
+    const unsigned elements = objective.dim1;
+    const int samples = objective.dim3;
+    costs.assign(candidates, 0.0);
+    for (unsigned i = 0; i < elements; i++) {
+        for (unsigned j = 0; j < elements; j++) {
+            const double* f = objective.begin() + (i * elements + j) * samples;
+            for (unsigned c = 0; c < candidates; c++) {
+                // same off-diagonal entries as time_of_flight::fill_from_diagonal.
+                const int k =
+                  (int)((batch(i, c) + batch(j, c)) / 2) - (int)offset;
+                costs[c] += k >= 0 && k < samples
+                              ? f[k]
+                              : -std::numeric_limits<double>::infinity();
+            }
+        }
+    }
+}
+
+void
+local_search_slave::search(const std::function<void(column&&)>& found)
+{
+    stop_watch time;
+    const unsigned elements = objective.dim1;
+    arr_2d<arr, unsigned> batch(elements, batch_size);
+    std::vector<double> costs;
+    std::vector<std::vector<unsigned>> returned;
+
+    for (const time_of_flight& centre : centres) {
+        if (cancelled) {
+            return;
+        }
+        if (centre.senders != elements) {
+            continue;
+        }
+        time_of_flight current(elements, elements, centre.representant_x);
+        std::copy(centre.begin(), centre.end(), current.begin());
+        for (unsigned e = 0; e < elements; e++) {
+            batch(e, 0) = current.at(e, e);
+        }
+        price(batch, 1, costs);
+        double current_cost = costs[0];
+
+        unsigned evaluated = 0;
+        unsigned moves = 0;
+        std::vector<unsigned> best_diagonal;
+        for (; moves < max_steps && !cancelled; moves++) {
+            double best_cost = current_cost;
+            best_diagonal.clear();
+            unsigned candidates = 0;
+            auto flush = [&]() {
+                if (cancelled) {
+                    return;
+                }
+                price(batch, candidates, costs);
+                for (unsigned c = 0; c < candidates; c++) {
+                    if (costs[c] > best_cost) {
+                        best_cost = costs[c];
+                        best_diagonal.resize(elements);
+                        for (unsigned e = 0; e < elements; e++) {
+                            best_diagonal[e] = batch(e, c);
+                        }
+                    }
+                }
+                evaluated += candidates;
+                candidates = 0;
+            };
+
+            n.for_each_neighbour(
+              current, radius, [&](const std::vector<unsigned>& diagonal) {
+                  for (unsigned e = 0; e < elements; e++) {
+                      batch(e, candidates) = diagonal[e];
+                  }
+                  if (++candidates == batch_size) {
+                      flush();
+                  }
+                  return !cancelled;
+              });
+            flush();
+
+            // a cancelled move was not fully priced, the moves before it are kept.
+            if (cancelled || best_diagonal.empty()) {
+                break;
+            }
+            for (unsigned e = 0; e < elements; e++) {
+                current.at(e, e) = best_diagonal[e];
+            }
+            current.fill_from_diagonal();
+            current_cost = best_cost;
+        }
+
+        std::vector<unsigned> diagonal(current.diagonal_begin(),
+                                       current.diagonal_end());
+        if (moves == 0 || current_cost <= threshold ||
+            std::find(returned.begin(), returned.end(), diagonal) !=
+              returned.end()) {
+            continue;
+        }
+        returned.push_back(std::move(diagonal));
+        found({ std::move(current),
+                slave_statistics{ current_cost,
+                                  time.elapsed(),
+                                  current_cost,
+                                  std::numeric_limits<double>::infinity(),
+                                  (double)evaluated,
+                                  (int)moves } });
+    }
+}
+
+void
+local_search_slave::run(proxy_arr<double>& f, columns& vars)
+{
+    cancel();
+    objective.realloca(f.dim1, f.dim2, f.dim3);
+    std::copy(f.begin(), f.end(), objective.begin());
+    cancelled = false;
+    search([&](column&& c) { vars.push_back(std::move(c)); });
+}
+
+void
+local_search_slave::run_async(proxy_arr<double>& f)
+{
+    cancel();
+    objective.realloca(f.dim1, f.dim2, f.dim3);
+    std::copy(f.begin(), f.end(), objective.begin());
+    cancelled = false;
+    thread = std::thread([this]() { search(solution_callback); });
+}
+
+void
+local_search_slave::cancel()
+{
+    cancelled = true;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool
+local_search_slave::ready()
+{
+    return true;
+}
@@ -0,0 +1,95 @@
+#ifndef LOCAL_SEARCH_SLAVE_H
+#define LOCAL_SEARCH_SLAVE_H
+
+#include "arr.h"
+#include "coordinates.h"
+#include "neighbours.h"
+#include "slave_problem.h"
+#include "statistics.h"
+#include "stop_watch.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+///@brief Finds new columns in the neighbourhoods of the columns used by the master.
+///
+/// Every column of the master with a positive amplitude is a centre, the local search moves each centre to its best
+/// feasible neighbour (see neighbours::for_each_neighbour) as long as this improves the reduced cost.
+/// The neighbours are priced in batches: their diagonals are stored as structure of arrays so that each
+/// sender-receiver-pair is looked up for all candidates at once.
+/// Cheap compared to the MIP slaves, it polishes the positions of the reflectors found so far.
+class local_search_slave
+  : public slave_problem
+  , public slave_problem_async
+{
+  public:
+    /// Receives every column whose reduced cost exceeds the threshold.
+    using callback = std::function<void(column&&)>;
+
+    local_search_slave(double element_pitch_in_tacts,
+                       unsigned radius,
+                       unsigned max_steps,
+                       unsigned offset,
+                       double threshold,
+                       callback solution_callback);
+
+    ~local_search_slave() override;
+
+    neighbours n;
+    /// Maximal change of the diagonal entries of a neighbour.
+    unsigned radius;
+    /// Maximal number of moves per centre.
+    unsigned max_steps;
+    unsigned offset;
+    /// Only columns with a reduced cost above threshold are returned.
+    double threshold;
+    callback solution_callback;
+
+    /// Maximal number of neighbours priced at once.
+    unsigned batch_size = 256;
+
+    /// Copies the variables with an amplitude > 0 as the new centres, cancels the running search.
+    void set_centres(const std::list<time_of_flight>& variables,
+                     const std::vector<double>& amplitudes);
+
+    /// Number of centres of the next search.
+    unsigned centres_size() const;
+
+    /// Searches synchronously and appends the improving columns to vars.
+    void run(proxy_arr<double>& f, columns& vars) override;
+
+    /// The centres are set by set_centres, hints are ignored.
+    void add_solution_start_hints(size,
+                                  std::vector<time_of_flight>&) override{};
+
+    ///@brief Searches in a separate thread and passes the improving columns to solution_callback.
+    ///
+    /// The search stops within one neighbour when it is cancelled, and set_centres cancels it after every master
+    /// solve : it only runs while the master waits for the slaves.
+    void run_async(proxy_arr<double>& f) override;
+    void cancel() override;
+    bool ready() override;
+
+  protected:
+    /// Runs the local search from all centres on the objective, calls found for every improving column.
+    void search(const std::function<void(column&&)>& found);
+
+    /// Reduced costs of the diagonals in batch (one column per candidate), -infinity when a tof leaves the samples.
+    void price(const arr_2d<arr, unsigned>& batch,
+               unsigned candidates,
+               std::vector<double>& costs) const;
+
+    /// Copy of the objective, the caller may change f while the search runs.
+    arr<> objective{ 0, 0, 0, nullptr };
+    std::vector<time_of_flight> centres;
+
+    std::thread thread;
+    std::atomic<bool> cancelled{ false };
+};
+
+#endif
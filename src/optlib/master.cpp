@@ -7,3 +7,27 @@ master_problem::master_problem(bool verbose, std::ostream& output, solver s)
 {}
 
 master_problem::~master_problem() {}
+
+void
+master_problem::add_variables(
+  std::vector<time_of_flight>& variables,
+  const arr<>& reference_signal,
+  std::optional<std::reference_wrapper<std::vector<double>>> warm_start_values)
+{
+    assert((!warm_start_values ||
+            warm_start_values->get().size() == variables.size()) &&
+           "Need one warm start value per variable!");
+    for (unsigned i = 0; i < variables.size(); i++) {
+        if (warm_start_values) {
+            add_variable(
+              variables[i], reference_signal, warm_start_values->get()[i]);
+        } else {
+            add_variable(variables[i], reference_signal, std::nullopt);
+        }
+    }
+}
+
+void
+master_problem::set_warm_start(const std::vector<double>& primal_values,
+                               const arr<>& duals)
+{}
@@ -6,8 +6,10 @@
 #include "coordinates.h"
 #include "slave_problem.h"
 #include <cassert>
+#include <functional>
 #include <list>
 #include <optional>
+#include <vector>
 
 /// @brief Represents the Reduced Master Problem
 ///
@@ -27,6 +29,8 @@ class master_problem
         SIMPLEX = 0,
         DUAL_SIMPLEX = 1,
         BARRIER = 2,
+        /// Runs all the other methods in parallel and stops with the fastest.
+        CONCURRENT = 3,
     };
 
     bool verbose;
@@ -54,7 +58,10 @@ class master_problem
       dual_solution& out,
       double& obj) = 0;
 
-    /// Removes the unused variables (that have value < threshold in solution) from the master.
+    /// The variables removed by the last clean(), moved out of name2tof.
+    std::vector<time_of_flight> cleaned;
+
+    /// Removes the unused variables (that have value < threshold in solution) from the master and moves them into cleaned.
     virtual unsigned clean() = 0;
 
     /// Add one Variable.
@@ -62,6 +69,20 @@ class master_problem
                               const arr<>& reference_signal,
                               std::optional<double> warm_start_value) = 0;
 
+    /// Add all variables (moved into name2tof), warm_start_values must have the same size as variables when given.
+    /// The default implementation calls add_variable for every variable.
+    virtual void add_variables(
+      std::vector<time_of_flight>& variables,
+      const arr<>& reference_signal,
+      std::optional<std::reference_wrapper<std::vector<double>>>
+        warm_start_values);
+
+    /// @brief The next solve starts from primal_values (same order as name2tof) and duals instead of the last solution.
+    ///
+    /// Used to polish an approximate solution, the default implementation ignores the warm start.
+    virtual void set_warm_start(const std::vector<double>& primal_values,
+                                const arr<>& duals);
+
     /// Return primal solution of last solve()-call.
     virtual void get_primal(std::vector<double>& primal_values,
                             arr<>& pos_slack,
@@ -3,3 +3,33 @@
 neighbours::neighbours(double element_pitch_in_tacts)
   : element_pitch_in_tacts(element_pitch_in_tacts)
 {}
+
+void
+neighbours::prepare_siblings(unsigned n, unsigned radius)
+{
+    if (siblings.size() == n && siblings[0]->capacity == 2 * radius &&
+        siblings[0]->double_element_pitch_in_tacts ==
+          2 * element_pitch_in_tacts) {
+        return;
+    }
+    siblings.clear();
+    for (unsigned d = 0; d < n; d++) {
+        siblings.push_back(std::make_unique<tof_feasibility_batch>(
+          d + 1, 2 * radius, element_pitch_in_tacts));
+    }
+}
+
+void
+neighbours::check_siblings(const time_of_flight& center, int depth, int radius)
+{
+    tof_feasibility_batch& batch = *siblings[depth];
+    batch.clear();
+    for (int s = -radius; s <= radius; s++) {
+        if (s == 0) {
+            continue;
+        }
+        path[depth] = center.at(depth, depth) + s;
+        batch.add(path.begin(), path.begin() + depth + 1);
+    }
+    batch.check();
+}
@@ -4,6 +4,8 @@
 #include "coordinates.h"
 #include <deque>
 #include <list>
+#include <memory>
+#include <vector>
 
 /// Represents a tree.
 template<typename T>
@@ -226,6 +228,18 @@ class builder
 /// Finds the neighbours of a given time of flight. The difficulty is to return only valid time of flights.
 class neighbours
 {
+    /// The diagonal of the current node of for_each_neighbour, path[d] is set for depths <= d.
+    std::vector<unsigned> path;
+    /// The change of the diagonal entry at every depth of for_each_neighbour.
+    std::vector<int> step;
+    /// siblings[d] checks the 2 * radius prefixes of length d + 1 that only differ in their last entry at once.
+    std::vector<std::unique_ptr<tof_feasibility_batch>> siblings;
+
+    /// Makes siblings fit n elements and radius.
+    void prepare_siblings(unsigned n, unsigned radius);
+    /// Checks all siblings of path[depth] (path[0..depth) is set) in siblings[depth].
+    void check_siblings(const time_of_flight& center, int depth, int radius);
+
   public:
     double element_pitch_in_tacts;
 
@@ -262,5 +276,55 @@ class neighbours
 
         std::for_each(root.leaf_begin(), root.leaf_end(), cb);
     }
+
+    ///@brief Calls cb(diagonal) for every valid neighbour of center, gives the same neighbours in the same order as the full-depth leafs of all_in_circle.
+    ///
+    /// cb returns false to stop the walk early.
+    /// Walks the tree of all_in_circle depth-first without building it : the path from the root is kept in one buffer that
+    /// is reused between calls, so no memory is allocated once the buffers have the size of the diagonal and the radius.
+    /// Subtrees below an infeasible prefix are skipped, like all_in_circle does. The 2 * radius siblings of a node are
+    /// checked together with a tof_feasibility_batch when the walk enters their depth; a prefix with an empty interval
+    /// is skipped instead of throwing.
+    template<typename CB>
+    void for_each_neighbour(const time_of_flight& center, unsigned radius, CB cb)
+    {
+        const unsigned n = center.senders;
+        if (n == 0 || radius == 0) {
+            return;
+        }
+        path.resize(n);
+        step.resize(n);
+        prepare_siblings(n, radius);
+
+        const std::vector<unsigned>& diagonal = path;
+        const int r = radius;
+        int depth = 0;
+        step[0] = -r - 1;
+        check_siblings(center, 0, r);
+        while (depth >= 0) {
+            // the next change at the current depth, 0 gives no neighbour.
+            if (++step[depth] == 0) {
+                ++step[depth];
+            }
+            if (step[depth] > r) {
+                depth--;
+                continue;
+            }
+            const unsigned sibling = step[depth] < 0 ? step[depth] + r
+                                                     : step[depth] + r - 1;
+            if (!siblings[depth]->feasible(sibling)) {
+                continue;
+            }
+            path[depth] = center.at(depth, depth) + step[depth];
+            if (depth + 1 == (int)n) {
+                if (!cb(diagonal)) {
+                    return;
+                }
+                continue;
+            }
+            step[++depth] = -r - 1;
+            check_siblings(center, depth, r);
+        }
+    }
 };
 #endif
@@ -0,0 +1,483 @@
+#ifndef PDHG_MASTER_H
+#define PDHG_MASTER_H
+
+#include "arr.h"
+#include "convolution.h"
+#include "coordinates.h"
+#include "exception.h"
+#include "master.h"
+#include "stop_watch.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <list>
+#include <optional>
+#include <random>
+#include <vector>
+
+///@brief A matrix-free master_problem implementation using the primal dual hybrid gradient method.
+///
+/// Solves the saddle point problem min_{x >= 0} max_{-1 <= y <= 1} y^T (m - Ax), whose y is the dual of the master.
+/// A is never stored: A x convolves a spike train (one spike per variable and sender-receiver-pair) with the reference,
+/// A^T y correlates y with the reference (same convolution as for the slave) and reads it at the tofs of the variables.
+/// Memory therefore only grows with the number of variables.
+/// The returned duals are approximate, an exact master can be given as polish to compute the final primal and duals
+/// starting from the PDHG solution.
+template<template<typename> class ConvolutionArray>
+class pdhg_master : public master_problem
+{
+  public:
+    /// Takes the ownership of forward, adjoint and polish.
+    pdhg_master(bool verbose,
+                std::ostream& output,
+                solver s,
+                double master_solution_threshold,
+                convolution* forward,
+                convolution* adjoint,
+                master_problem* polish);
+    ~pdhg_master() override;
+
+    /// Masterclean : variables having an value < threshold are automatically removed from the master.
+    double threshold;
+
+    /// Computes A x.
+    convolution* forward;
+    /// Computes the correlation needed by A^T y.
+    convolution* adjoint;
+    /// Optional exact master that computes the final duals from the PDHG solution.
+    master_problem* polish;
+
+    /// Stop when the relative duality gap and the relative dual infeasibility are below this value.
+    double tolerance = 1e-4;
+    /// Maximal PDHG iterations per solve.
+    unsigned max_iterations = 5000;
+    /// The convergence is checked every check_interval iterations.
+    unsigned check_interval = 50;
+    /// PDHG iterations done in the last solve.
+    unsigned iterations = 0;
+
+    /// Values of the variables.
+    std::vector<double> primal;
+
+    virtual void solve_reduced_problem(
+      int elements,
+      unsigned offset,
+      arr<>& measurement,
+      arr<>& reference_signal,
+      std::optional<solver> enforce_particular_solver,
+      dual_solution& out,
+      double& obj) override;
+
+    virtual void add_variable(time_of_flight& variable,
+                              const arr<>& reference_signal,
+                              std::optional<double> warm_start_value) override;
+
+    virtual void get_primal(std::vector<double>& primal_values) override;
+
+    virtual void get_primal(std::vector<double>& primal_values,
+                            arr<>& pos_slack,
+                            arr<>& neg_slack) override;
+
+    virtual unsigned clean() override;
+
+  protected:
+    bool started = false;
+    unsigned offset = 0;
+    unsigned reference_samples = 0;
+    /// Set when the variables changed and the operator norm has to be recomputed.
+    bool norm_outdated = true;
+    /// Estimation of the operator norm of A.
+    double norm = 0.0;
+
+    ConvolutionArray<double> measurement_values;
+    arr_1d<ConvolutionArray, double> reference;
+    arr_1d<ConvolutionArray, double> inverted_reference;
+
+    /// The dual values y.
+    ConvolutionArray<double> dual;
+    /// m - A x of the last primal iterate.
+    ConvolutionArray<double> residual;
+    /// Spike train of x, shifted by reference_samples - 1.
+    ConvolutionArray<double> spikes;
+    /// Untrimmed A x.
+    ConvolutionArray<double> simulation;
+    /// Correlation of y with the reference, shifted by reference_samples - 1.
+    ConvolutionArray<double> correlation;
+
+    /// Returns the position of the spike of variable tof for sender-receiver-pair (i, j) or -1 if outside.
+    int spike_position(const time_of_flight& tof, unsigned i, unsigned j) const;
+    /// Computes residual = m - A x.
+    void apply_forward(const std::vector<double>& x);
+    /// Computes out = A^T y.
+    void apply_adjoint(arr<>& y, std::vector<double>& out);
+    /// Estimates the operator norm of A by power iteration.
+    void estimate_norm();
+    /// Sum of |residual|.
+    double residual_norm() const;
+};
+
+template<template<typename> class ConvolutionArray>
+pdhg_master<ConvolutionArray>::pdhg_master(bool verbose,
+                                           std::ostream& output,
+                                           solver s,
+                                           double master_solution_threshold,
+                                           convolution* forward,
+                                           convolution* adjoint,
+                                           master_problem* polish)
+  : master_problem(verbose, output, s)
+  , threshold(master_solution_threshold)
+  , forward(forward)
+  , adjoint(adjoint)
+  , polish(polish)
+  , measurement_values(0, 0, 0)
+  , reference(0)
+  , inverted_reference(0)
+  , dual(0, 0, 0)
+  , residual(0, 0, 0)
+  , spikes(0, 0, 0)
+  , simulation(0, 0, 0)
+  , correlation(0, 0, 0)
+{}
+
+template<template<typename> class ConvolutionArray>
+pdhg_master<ConvolutionArray>::~pdhg_master()
+{
+    delete forward;
+    delete adjoint;
+    delete polish;
+}
+
+template<template<typename> class ConvolutionArray>
+int
+pdhg_master<ConvolutionArray>::spike_position(const time_of_flight& tof,
+                                              unsigned i,
+                                              unsigned j) const
+{
+    // A_{ijk} = reference(k + offset - tof(i, j)) as in grb_master.
+    const int position =
+      (int)tof.at(i, j) - (int)offset + (int)reference_samples - 1;
+    if (position < 0 || position >= (int)spikes.dim3) {
+        return -1;
+    }
+    return position;
+}
+
+template<template<typename> class ConvolutionArray>
+void
+pdhg_master<ConvolutionArray>::apply_forward(const std::vector<double>& x)
+{
+    spikes.for_each([](double& d) { d = 0.0; });
+    unsigned v = 0;
+    for (const time_of_flight& tof : name2tof) {
+        const double value = x[v++];
+        if (value == 0.0) {
+            continue;
+        }
+        for (unsigned i = 0; i < spikes.dim1; i++) {
+            for (unsigned j = 0; j < spikes.dim2; j++) {
+                const int position = spike_position(tof, i, j);
+                if (position >= 0) {
+                    spikes(i, j, position) += value;
+                }
+            }
+        }
+    }
+
+    forward->convolve(spikes, reference, simulation);
+    residual.for_ijkv([&](unsigned i, unsigned j, unsigned k, double& r) {
+        r = measurement_values(i, j, k) -
+            simulation(i, j, k + reference_samples - 1);
+    });
+}
+
+template<template<typename> class ConvolutionArray>
+void
+pdhg_master<ConvolutionArray>::apply_adjoint(arr<>& y, std::vector<double>& out)
+{
+    adjoint->convolve(y, inverted_reference, correlation);
+    out.resize(name2tof.size());
+    unsigned v = 0;
+    for (const time_of_flight& tof : name2tof) {
+        double sum = 0.0;
+        for (unsigned i = 0; i < correlation.dim1; i++) {
+            for (unsigned j = 0; j < correlation.dim2; j++) {
+                const int position = spike_position(tof, i, j);
+                if (position >= 0) {
+                    sum += correlation(i, j, position);
+                }
+            }
+        }
+        out[v++] = sum;
+    }
+}
+
+template<template<typename> class ConvolutionArray>
+void
+pdhg_master<ConvolutionArray>::estimate_norm()
+{
+    const unsigned n = name2tof.size();
+    norm_outdated = false;
+    if (n == 0) {
+        norm = 0.0;
+        return;
+    }
+
+    // power iteration on A^T A, residual = -A v because measurement is subtracted.
+    std::mt19937 generator(n);
+    std::uniform_real_distribution<double> distribution(0.5, 1.0);
+    std::vector<double> v(n), w(n);
+    std::generate(v.begin(), v.end(), [&]() { return distribution(generator); });
+
+    ConvolutionArray<double> simulated(
+      residual.dim1, residual.dim2, residual.dim3);
+    double eigenvalue = 0.0;
+    for (unsigned iteration = 0; iteration < 20; iteration++) {
+        double length = std::sqrt(
+          std::inner_product(v.begin(), v.end(), v.begin(), 0.0));
+        if (length == 0.0) {
+            break;
+        }
+        std::for_each(v.begin(), v.end(), [&](double& d) { d /= length; });
+        apply_forward(v);
+        simulated.for_ijkv([&](unsigned i, unsigned j, unsigned k, double& s) {
+            s = measurement_values(i, j, k) - residual(i, j, k);
+        });
+        apply_adjoint(simulated, w);
+        eigenvalue = std::inner_product(v.begin(), v.end(), w.begin(), 0.0);
+        std::swap(v, w);
+    }
+    // safety margin for the inexact estimation
+    norm = 1.1 * std::sqrt(std::max(eigenvalue, 0.0));
+}
+
+template<template<typename> class ConvolutionArray>
+double
+pdhg_master<ConvolutionArray>::residual_norm() const
+{
+    double sum = 0.0;
+    for (const double r : residual) {
+        sum += std::abs(r);
+    }
+    return sum;
+}
+
+template<template<typename> class ConvolutionArray>
+void
+pdhg_master<ConvolutionArray>::solve_reduced_problem(
+  int elements,
+  unsigned offset,
+  arr<>& measurement,
+  arr<>& reference_signal,
+  std::optional<solver> enforce_particular_solver,
+  dual_solution& out,
+  double& obj)
+{
+    assert(measurement.same_dim(out.values) && "Incompatible dimensions!");
+    stop_watch watch;
+    this->offset = offset;
+
+    if (!started) {
+        const unsigned senders = measurement.dim1;
+        const unsigned receivers = measurement.dim2;
+        const unsigned samples = measurement.dim3;
+        reference_samples = reference_signal.dim3;
+
+        measurement_values.realloca(senders, receivers, samples);
+        measurement_values.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+            return measurement(i, j, k);
+        });
+        reference.realloca(1, 1, reference_samples);
+        reference.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+            return reference_signal(i, j, k);
+        });
+        inverted_reference.realloca(1, 1, reference_samples);
+        reference.invert(inverted_reference);
+
+        dual.realloca(senders, receivers, samples);
+        residual.realloca(senders, receivers, samples);
+        spikes.realloca(senders, receivers, samples + reference_samples - 1);
+        simulation.realloca(
+          senders, receivers, samples + 2 * reference_samples - 2);
+        correlation.realloca(
+          senders, receivers, samples + reference_samples - 1);
+
+        // start with the optimal dual of the master without variables.
+        dual.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+            return measurement_values(i, j, k) >= 0.0 ? 1.0 : -1.0;
+        });
+        started = true;
+    }
+
+    if (norm_outdated) {
+        estimate_norm();
+    }
+
+    const unsigned n = name2tof.size();
+    std::vector<double> gradient(n), previous(n), extrapolated(n);
+    iterations = 0;
+    if (n > 0 && norm > 0.0) {
+        const double tau = 0.9 / norm;
+        const double sigma = 0.9 / norm;
+        while (iterations < max_iterations) {
+            // primal step : x = max(0, x + tau A^T y)
+            apply_adjoint(dual, gradient);
+            previous = primal;
+            for (unsigned v = 0; v < n; v++) {
+                primal[v] = std::max(0.0, primal[v] + tau * gradient[v]);
+                extrapolated[v] = 2.0 * primal[v] - previous[v];
+            }
+
+            // dual step : y = clip(y + sigma (m - A (2x - x_old)))
+            apply_forward(extrapolated);
+            dual.for_ijkv([&](unsigned i, unsigned j, unsigned k, double& y) {
+                y = std::clamp(y + sigma * residual(i, j, k), -1.0, 1.0);
+            });
+            iterations++;
+
+            if (iterations % check_interval == 0) {
+                apply_forward(primal);
+                apply_adjoint(dual, gradient);
+                const double primal_obj = residual_norm();
+                const double dual_obj = std::inner_product(
+                  dual.begin(), dual.end(), measurement_values.begin(), 0.0);
+                const double dual_infeasibility =
+                  std::max(0.0, *std::max_element(gradient.begin(), gradient.end()));
+                const double scale = std::max(1.0, std::abs(primal_obj));
+                if (std::abs(primal_obj - dual_obj) <= tolerance * scale &&
+                    dual_infeasibility <= tolerance * norm) {
+                    break;
+                }
+            }
+        }
+    }
+
+    apply_forward(primal);
+    obj = residual_norm();
+
+    if (polish) {
+        polish->set_warm_start(primal, dual);
+        polish->solve_reduced_problem(elements,
+                                      offset,
+                                      measurement,
+                                      reference_signal,
+                                      enforce_particular_solver,
+                                      out,
+                                      obj);
+        polish->get_primal(primal);
+        apply_forward(primal);
+        std::copy(out.values.begin(), out.values.end(), dual.data);
+    } else {
+        std::copy(dual.begin(), dual.end(), out.values.data);
+    }
+    get_primal(name2amplitude);
+
+    out.stats = {
+        obj,
+        watch.elapsed(),
+        0.0,
+    };
+
+    if (verbose) {
+        output << " ====(Master)==== " << iterations
+               << " PDHG iterations, objective " << obj << std::endl;
+    }
+}
+
+template<template<typename> class ConvolutionArray>
+void
+pdhg_master<ConvolutionArray>::add_variable(
+  time_of_flight& variable,
+  const arr<>& reference_signal,
+  std::optional<double> warm_start_value)
+{
+    assert(started && "Solve the master once before adding variables!");
+    assert(variable.senders == dual.dim1 && variable.receivers == dual.dim2 &&
+           "Variable incompatible with model!");
+
+    if (polish) {
+        time_of_flight copy(
+          variable.senders, variable.receivers, variable.representant_x);
+        std::copy(variable.begin(), variable.end(), copy.begin());
+        polish->add_variable(copy, reference_signal, warm_start_value);
+    }
+
+    name2tof.push_back(std::move(variable));
+    name2amplitude.push_back(0.0);
+    primal.push_back(std::max(0.0, warm_start_value.value_or(0.0)));
+    norm_outdated = true;
+}
+
+template<template<typename> class ConvolutionArray>
+unsigned
+pdhg_master<ConvolutionArray>::clean()
+{
+    cleaned.clear();
+    unsigned deleted_vars = 0;
+    auto tof = name2tof.begin();
+    auto value = primal.begin();
+
+    if (polish) {
+        // the polish decides, keep the variables it kept (order is preserved by both).
+        polish->clean();
+        polish->cleaned.clear();
+        auto kept = polish->name2tof.begin();
+        while (tof != name2tof.end()) {
+            if (kept != polish->name2tof.end() &&
+                std::equal(tof->begin(), tof->end(), kept->begin())) {
+                tof++;
+                value++;
+                kept++;
+            } else {
+                cleaned.push_back(std::move(*tof));
+                tof = name2tof.erase(tof);
+                value = primal.erase(value);
+                deleted_vars++;
+            }
+        }
+    } else {
+        while (tof != name2tof.end()) {
+            if (*value < threshold) {
+                cleaned.push_back(std::move(*tof));
+                tof = name2tof.erase(tof);
+                value = primal.erase(value);
+                deleted_vars++;
+            } else {
+                tof++;
+                value++;
+            }
+        }
+    }
+
+    if (deleted_vars > 0) {
+        norm_outdated = true;
+    }
+    /// Reconstruct the name2amplitude vector.
+    get_primal(name2amplitude);
+    return deleted_vars;
+}
+
+template<template<typename> class ConvolutionArray>
+void
+pdhg_master<ConvolutionArray>::get_primal(std::vector<double>& primal_values)
+{
+    primal_values = primal;
+}
+
+template<template<typename> class ConvolutionArray>
+void
+pdhg_master<ConvolutionArray>::get_primal(std::vector<double>& primal_values,
+                                          arr<>& pos_slack,
+                                          arr<>& neg_slack)
+{
+    // residual = neg_slack - pos_slack
+    pos_slack.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+        return std::max(0.0, -residual(i, j, k));
+    });
+    neg_slack.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+        return std::max(0.0, residual(i, j, k));
+    });
+
+    get_primal(primal_values);
+}
+
+#endif
@@ -103,3 +103,32 @@ saft::populate_from(const arr_2d<arr, double>& saft_image,
         populate_me.push_back(std::move(tof));
     }
 }
+
+void
+saft::grid_tofs(std::vector<time_of_flight>& populate_me)
+{
+    std::set<std::reference_wrapper<time_of_flight>> already_added;
+    std::list<time_of_flight> unique_tofs;
+    for (unsigned i = 0; i < width; i++) {
+        for (unsigned j = 0; j < height; j++) {
+            double x, y;
+            c.pixel_to_tact_coords(width, height, i, j, x, y);
+
+            time_of_flight t(c.elements, c.elements, x);
+            c.tact_coords_to_tof(x, y, t);
+            if (!t.in_bounds(c.get_roi_start(), c.get_roi_end())) {
+                continue;
+            }
+
+            unique_tofs.push_back(std::move(t));
+            if (!already_added.insert(unique_tofs.back()).second) {
+                unique_tofs.pop_back();
+            }
+        }
+    }
+
+    populate_me.reserve(populate_me.size() + unique_tofs.size());
+    for (time_of_flight& tof : unique_tofs) {
+        populate_me.push_back(std::move(tof));
+    }
+}
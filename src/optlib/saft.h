@@ -37,6 +37,8 @@ struct saft
                        double threshold,
                        std::vector<time_of_flight>& populate_me,
                        optional_value_vector);
+    /// Converts every pixel of the image into a tof, tofs leaving the ROI [roi_start, roi_end) and duplicates are skipped.
+    void grid_tofs(std::vector<time_of_flight>& populate_me);
     /// Computes SAFT from measurement and write it into image.
     void compute(const arr<>& measurement, arr_2d<arr, double>& image);
 
@@ -0,0 +1,952 @@
+#include "simplex_master.h"
+
+/// Reduced costs above -optimality_tolerance are treated as non improving.
+static const double optimality_tolerance = 1e-7;
+/// Entries of a direction below pivot_tolerance are treated as zero.
+static const double pivot_tolerance = 1e-9;
+/// After this many steps of length 0 the smallest index rule is used to avoid cycling.
+static const unsigned max_degenerated_steps = 50;
+/// Basic variables and residual are recomputed from scratch every refresh_interval iterations.
+static const unsigned refresh_interval = 100;
+/// The basis is factorised from scratch after max_updates updates.
+static const unsigned max_updates = 64;
+
+double
+simplex_master::sparse_column::at(unsigned row) const
+{
+    auto it = std::upper_bound(
+      segments.begin(), segments.end(), row, [](unsigned row, const segment& s) {
+          return row < s.row;
+      });
+    if (it == segments.begin()) {
+        return 0.0;
+    }
+    --it;
+    if (row >= it->row + it->length) {
+        return 0.0;
+    }
+    return values[it->value + row - it->row];
+}
+
+double
+simplex_master::sparse_column::dot(const std::vector<double>& dense) const
+{
+    double sum = 0.0;
+    for (const segment& s : segments) {
+        const double* v = &values[s.value];
+        sum = std::inner_product(v, v + s.length, &dense[s.row], sum);
+    }
+    return sum;
+}
+
+void
+simplex_master::sparse_column::add_to(double factor,
+                                      std::vector<double>& dense) const
+{
+    for (const segment& s : segments) {
+        const double* v = &values[s.value];
+        double* d = &dense[s.row];
+        for (unsigned l = 0; l < s.length; l++) {
+            d[l] += factor * v[l];
+        }
+    }
+}
+
+simplex_master::simplex_master(bool verbose,
+                               std::ostream& output,
+                               solver s,
+                               double master_solution_threshold)
+  : master_problem(verbose, output, s)
+  , threshold(master_solution_threshold)
+  , factorised_size(0)
+  , stale_factorisation(false)
+  , choose_slacks(false)
+  , iterations(0)
+  , offset(0)
+  , started(false)
+{}
+
+simplex_master::~simplex_master() {}
+
+void
+simplex_master::set_start_variables(arr<>& measurement)
+{
+    senders = measurement.dim1;
+    receivers = measurement.dim2;
+    measurement_samples = measurement.dim3;
+
+    const unsigned rows = measurement.size();
+    measurement_values.resize(rows);
+    unsigned row = 0;
+    for (unsigned i = 0; i < senders; i++) {
+        for (unsigned j = 0; j < receivers; j++) {
+            for (unsigned k = 0; k < measurement_samples; k++) {
+                measurement_values[row++] = measurement(i, j, k);
+            }
+        }
+    }
+
+    // all slack basis : the dual of a row is the sign of its basic slack.
+    residual = measurement_values;
+    side.resize(rows);
+    dual.resize(rows);
+    for (row = 0; row < rows; row++) {
+        side[row] = residual[row] >= 0.0 ? 1 : -1;
+        dual[row] = side[row];
+    }
+    row_slot.assign(rows, no_slot);
+    touched.assign(rows, false);
+    residual_direction.assign(rows, 0.0);
+    basic_variables.clear();
+    tight_rows.clear();
+    free_slots.clear();
+}
+
+void
+simplex_master::solve_reduced_problem(
+  int elements,
+  unsigned offset,
+  arr<>& measurement,
+  arr<>& reference_signal,
+  std::optional<solver> enforce_particular_solver,
+  dual_solution& out,
+  double& obj)
+{
+    assert(measurement.same_dim(out.values) && "Incompatible dimensions!");
+    stop_watch watch;
+    this->offset = offset;
+
+    if (!started) {
+        set_start_variables(measurement);
+        started = true;
+    }
+
+    if (warm_start_primal) {
+        crash_basis();
+    } else {
+        factorise();
+        recompute_primal();
+    }
+
+    iterations = 0;
+    unsigned degenerated_steps = 0;
+    candidate c;
+    while (true) {
+        compute_duals();
+        if (!price(c, degenerated_steps > max_degenerated_steps)) {
+            break;
+        }
+        compute_direction(c);
+        const double length = step(c);
+        degenerated_steps = length > 0.0 ? 0 : degenerated_steps + 1;
+        iterations++;
+
+        if (stale_factorisation || etas.size() >= max_updates) {
+            factorise();
+            recompute_primal();
+        } else if (iterations % refresh_interval == 0) {
+            recompute_primal();
+        }
+    }
+
+    obj = objective();
+    std::copy(dual.begin(), dual.end(), out.values.data);
+    get_primal(name2amplitude);
+
+    out.stats = {
+        obj,
+        watch.elapsed(),
+        0.0,
+    };
+
+    if (verbose) {
+        output << " ====(Master)==== " << iterations
+               << " simplex iterations, objective " << obj << std::endl;
+    }
+}
+
+void
+simplex_master::add_variable(time_of_flight& variable,
+                             const arr<>& reference_signal,
+                             std::optional<double> warm_start_value)
+{
+    assert(started && "Solve the master once before adding variables!");
+    assert(variable.senders == senders && variable.receivers == receivers &&
+           "Variable incompatible with model!");
+
+    sparse_column add_me;
+    for (unsigned i = 0; i < senders; i++) {
+        for (unsigned j = 0; j < receivers; j++) {
+            // same shift as in grb_master : A_{ijk} = reference(k + t_helper)
+            const int t_helper = (int)offset - (int)variable.at(i, j);
+            const int first = std::max(0, -t_helper);
+            const int last = std::min((int)measurement_samples,
+                                      (int)reference_signal.dim3 - t_helper);
+            if (first >= last) {
+                continue;
+            }
+            const unsigned row = (i * receivers + j) * measurement_samples;
+            add_me.segments.push_back({ row + first,
+                                        (unsigned)(last - first),
+                                        (unsigned)add_me.values.size() });
+            for (int k = first; k < last; k++) {
+                add_me.values.push_back(reference_signal(i, j, k + t_helper));
+            }
+        }
+    }
+
+    variables.push_back(std::move(add_me));
+    primal.push_back(0.0);
+    name2tof.push_back(std::move(variable));
+    name2amplitude.push_back(0.0);
+}
+
+unsigned
+simplex_master::clean()
+{
+    cleaned.clear();
+    std::vector<bool> basic(variables.size(), false);
+    for (unsigned b : basic_variables) {
+        if (b != no_slot) {
+            basic[b] = true;
+        }
+    }
+
+    std::vector<unsigned> new_index(variables.size());
+    unsigned kept = 0;
+    auto tof = name2tof.begin();
+    for (unsigned v = 0; v < variables.size(); v++) {
+        //do not remove basic variables as they require to start solving the LP from start.
+        if (primal[v] < threshold && !basic[v]) {
+            cleaned.push_back(std::move(*tof));
+            tof = name2tof.erase(tof);
+            continue;
+        }
+        new_index[v] = kept;
+        if (kept != v) {
+            variables[kept] = std::move(variables[v]);
+            primal[kept] = primal[v];
+        }
+        kept++;
+        tof++;
+    }
+
+    const unsigned deleted_vars = variables.size() - kept;
+    variables.resize(kept);
+    primal.resize(kept);
+    for (unsigned& b : basic_variables) {
+        if (b != no_slot) {
+            b = new_index[b];
+        }
+    }
+
+    /// Reconstruct the name2amplitude vector.
+    get_primal(name2amplitude);
+    return deleted_vars;
+}
+
+void
+simplex_master::set_warm_start(const std::vector<double>& primal_values,
+                               const arr<>& duals)
+{
+    assert(primal_values.size() == variables.size() &&
+           "Need one warm start value per variable!");
+    warm_start_primal = primal_values;
+}
+
+void
+simplex_master::crash_basis()
+{
+    std::vector<double> start_residual = measurement_values;
+    std::vector<unsigned> candidates;
+    for (unsigned v = 0; v < variables.size(); v++) {
+        primal[v] = 0.0;
+        if ((*warm_start_primal)[v] > 0.0) {
+            variables[v].add_to(-(*warm_start_primal)[v], start_residual);
+            candidates.push_back(v);
+        }
+    }
+    std::stable_sort(
+      candidates.begin(), candidates.end(), [&](unsigned l, unsigned r) {
+          return (*warm_start_primal)[l] > (*warm_start_primal)[r];
+      });
+    warm_start_primal.reset();
+
+    basic_variables.clear();
+    tight_rows.clear();
+    std::fill(row_slot.begin(), row_slot.end(), no_slot);
+    for (unsigned v : candidates) {
+        unsigned best = no_slot;
+        for (const sparse_column::segment& s : variables[v].segments) {
+            for (unsigned row = s.row; row < s.row + s.length; row++) {
+                if (row_slot[row] == no_slot &&
+                    (best == no_slot || std::abs(start_residual[row]) <
+                                          std::abs(start_residual[best]))) {
+                    best = row;
+                }
+            }
+        }
+        if (best != no_slot) {
+            row_slot[best] = tight_rows.size();
+            tight_rows.push_back(best);
+            basic_variables.push_back(v);
+        }
+    }
+
+    bool feasible = false;
+    while (!feasible) {
+        choose_slacks = true;
+        factorise();
+        recompute_primal();
+        feasible = true;
+        for (unsigned b = 0; b < basic_variables.size(); b++) {
+            if (primal[basic_variables[b]] < -pivot_tolerance) {
+                primal[basic_variables[b]] = 0.0;
+                basic_variables[b] = no_slot;
+                row_slot[tight_rows[b]] = no_slot;
+                tight_rows[b] = no_slot;
+                feasible = false;
+            }
+        }
+    }
+}
+
+void
+simplex_master::get_primal(std::vector<double>& primal_values)
+{
+    primal_values = primal;
+}
+
+void
+simplex_master::get_primal(std::vector<double>& primal_values,
+                           arr<>& pos_slack,
+                           arr<>& neg_slack)
+{
+    // residual = neg_slack - pos_slack
+    unsigned row = 0;
+    for (unsigned i = 0; i < pos_slack.dim1; i++) {
+        for (unsigned j = 0; j < pos_slack.dim2; j++) {
+            for (unsigned k = 0; k < pos_slack.dim3; k++) {
+                pos_slack.at(i, j, k) = std::max(0.0, -residual[row]);
+                neg_slack.at(i, j, k) = std::max(0.0, residual[row]);
+                row++;
+            }
+        }
+    }
+
+    get_primal(primal_values);
+}
+
+void
+simplex_master::recompute_primal()
+{
+    const unsigned k = basic_variables.size();
+    std::vector<double> x(k, 0.0);
+    for (unsigned a = 0; a < k; a++) {
+        if (tight_rows[a] != no_slot) {
+            x[a] = measurement_values[tight_rows[a]];
+        }
+    }
+    solve(x);
+
+    residual = measurement_values;
+    for (unsigned b = 0; b < k; b++) {
+        if (basic_variables[b] != no_slot) {
+            primal[basic_variables[b]] = x[b];
+            variables[basic_variables[b]].add_to(-x[b], residual);
+        }
+    }
+    for (unsigned row : tight_rows) {
+        if (row != no_slot) {
+            residual[row] = 0.0;
+        }
+    }
+    if (choose_slacks) {
+        for (unsigned row = 0; row < residual.size(); row++) {
+            if (row_slot[row] != no_slot) {
+                continue;
+            }
+            if (side[row] * residual[row] < 0.0) {
+                side[row] = -side[row];
+            }
+            dual[row] = side[row];
+        }
+        choose_slacks = false;
+    }
+}
+
+void
+simplex_master::compute_duals()
+{
+    const unsigned k = basic_variables.size();
+    for (unsigned row : tight_rows) {
+        if (row != no_slot) {
+            dual[row] = 0.0;
+        }
+    }
+
+    // A_{T,K}^T y_T = - A_{not T,K}^T y_{not T}
+    std::vector<double> y(k, 0.0);
+    for (unsigned b = 0; b < k; b++) {
+        if (basic_variables[b] != no_slot) {
+            y[b] = -variables[basic_variables[b]].dot(dual);
+        }
+    }
+    solve_transposed(y);
+
+    for (unsigned a = 0; a < k; a++) {
+        if (tight_rows[a] != no_slot) {
+            dual[tight_rows[a]] = y[a];
+        }
+    }
+}
+
+bool
+simplex_master::price(candidate& c, bool smallest_index)
+{
+    std::vector<bool> basic(variables.size(), false);
+    for (unsigned b : basic_variables) {
+        if (b != no_slot) {
+            basic[b] = true;
+        }
+    }
+
+    bool found = false;
+    c.reduced_cost = -optimality_tolerance;
+    auto consider = [&](bool release, unsigned index, int sigma, double d) {
+        if (d < c.reduced_cost) {
+            c = { release, index, sigma, d };
+            found = true;
+        }
+    };
+
+    for (unsigned v = 0; v < variables.size(); v++) {
+        if (basic[v]) {
+            continue;
+        }
+        consider(false, v, 0, -variables[v].dot(dual));
+        if (found && smallest_index) {
+            return true;
+        }
+    }
+
+    for (unsigned a = 0; a < tight_rows.size(); a++) {
+        if (tight_rows[a] == no_slot) {
+            continue;
+        }
+        const double y = dual[tight_rows[a]];
+        // reduced costs of the negative and the positive slack.
+        consider(true, a, 1, 1.0 - y);
+        consider(true, a, -1, 1.0 + y);
+        if (found && smallest_index) {
+            return true;
+        }
+    }
+    return found;
+}
+
+void
+simplex_master::add_to_direction(double factor, const sparse_column& v)
+{
+    for (const sparse_column::segment& s : v.segments) {
+        for (unsigned l = 0; l < s.length; l++) {
+            const unsigned row = s.row + l;
+            if (!touched[row]) {
+                touched[row] = true;
+                touched_rows.push_back(row);
+            }
+            residual_direction[row] += factor * v.values[s.value + l];
+        }
+    }
+}
+
+void
+simplex_master::compute_direction(const candidate& c)
+{
+    for (unsigned row : touched_rows) {
+        residual_direction[row] = 0.0;
+        touched[row] = false;
+    }
+    touched_rows.clear();
+
+    const unsigned k = basic_variables.size();
+    basic_direction.assign(k, 0.0);
+    if (c.release) {
+        basic_direction[c.index] = 1.0;
+        solve(basic_direction);
+        for (double& d : basic_direction) {
+            d *= -c.sigma;
+        }
+    } else {
+        const sparse_column& entering = variables[c.index];
+        column_of(c.index, basic_direction);
+        solve(basic_direction);
+        for (double& d : basic_direction) {
+            d = -d;
+        }
+        add_to_direction(-1.0, entering);
+    }
+
+    for (unsigned b = 0; b < k; b++) {
+        if (basic_variables[b] == no_slot) {
+            basic_direction[b] = 0.0;
+            continue;
+        }
+        add_to_direction(-basic_direction[b], variables[basic_variables[b]]);
+    }
+
+    // remove numerical noise : tight rows stay tight except the released one.
+    for (unsigned row : tight_rows) {
+        if (row != no_slot) {
+            residual_direction[row] = 0.0;
+        }
+    }
+    if (c.release) {
+        residual_direction[tight_rows[c.index]] = c.sigma;
+    }
+}
+
+double
+simplex_master::step(const candidate& c)
+{
+    const unsigned k = basic_variables.size();
+
+    // basic variables must stay positive
+    const double infinity = std::numeric_limits<double>::infinity();
+    double hard_bound = infinity;
+    unsigned leaving_variable = k;
+    for (unsigned b = 0; b < k; b++) {
+        if (basic_variables[b] != no_slot &&
+            basic_direction[b] < -pivot_tolerance) {
+            const double t =
+              std::max(0.0, primal[basic_variables[b]]) / -basic_direction[b];
+            if (t < hard_bound) {
+                hard_bound = t;
+                leaving_variable = b;
+            }
+        }
+    }
+
+    // kinks of |residual|
+    breakpoints.clear();
+    for (unsigned row : touched_rows) {
+        const double d = residual_direction[row];
+        if (row_slot[row] != no_slot || std::abs(d) <= pivot_tolerance ||
+            side[row] * d > 0) {
+            continue;
+        }
+        const double t = std::max(0.0, side[row] * residual[row]) / std::abs(d);
+        if (t < hard_bound) {
+            breakpoints.emplace_back(t, row);
+        }
+    }
+    std::sort(breakpoints.begin(), breakpoints.end());
+
+    double slope = c.reduced_cost;
+    double length = hard_bound;
+    std::optional<unsigned> leaving_row;
+    for (auto [t, row] : breakpoints) {
+        slope += 2.0 * std::abs(residual_direction[row]);
+        if (slope >= 0.0) {
+            length = t;
+            leaving_row = row;
+            break;
+        }
+        // the row passes its kink : the other slack becomes basic.
+        side[row] = -side[row];
+        dual[row] = side[row];
+    }
+    assert_that(length < infinity, "Master problem is unbounded!");
+
+    for (unsigned b = 0; b < k; b++) {
+        if (basic_variables[b] != no_slot) {
+            primal[basic_variables[b]] += length * basic_direction[b];
+        }
+    }
+    for (unsigned row : touched_rows) {
+        residual[row] += length * residual_direction[row];
+    }
+
+    if (c.release) {
+        const unsigned released = tight_rows[c.index];
+        side[released] = c.sigma;
+        dual[released] = c.sigma;
+        if (leaving_row) {
+            replace_tight_row(c.index, *leaving_row);
+        } else {
+            primal[basic_variables[leaving_variable]] = 0.0;
+            shrink_basis(c.index, leaving_variable);
+        }
+    } else {
+        primal[c.index] = length;
+        if (leaving_row) {
+            grow_basis(c.index, *leaving_row);
+        } else {
+            primal[basic_variables[leaving_variable]] = 0.0;
+            replace_basic_variable(leaving_variable, c.index);
+        }
+    }
+    if (leaving_row) {
+        residual[*leaving_row] = 0.0;
+    }
+    return length;
+}
+
+void
+simplex_master::column_of(unsigned variable, std::vector<double>& out) const
+{
+    std::fill(out.begin(), out.end(), 0.0);
+    const sparse_column& v = variables[variable];
+    for (const sparse_column::segment& s : v.segments) {
+        for (unsigned l = 0; l < s.length; l++) {
+            const unsigned slot = row_slot[s.row + l];
+            if (slot != no_slot) {
+                out[slot] = v.values[s.value + l];
+            }
+        }
+    }
+}
+
+void
+simplex_master::row_of(unsigned row, std::vector<double>& out) const
+{
+    for (unsigned b = 0; b < basic_variables.size(); b++) {
+        out[b] = basic_variables[b] == no_slot
+                   ? 0.0
+                   : variables[basic_variables[b]].at(row);
+    }
+}
+
+void
+simplex_master::replace_tight_row(unsigned slot, unsigned row)
+{
+    const unsigned k = basic_variables.size();
+    std::vector<double> difference(k), old_row(k);
+    row_of(row, difference);
+    row_of(tight_rows[slot], old_row);
+    for (unsigned b = 0; b < k; b++) {
+        difference[b] -= old_row[b];
+    }
+
+    row_slot[tight_rows[slot]] = no_slot;
+    row_slot[row] = slot;
+    tight_rows[slot] = row;
+    update_row(slot, std::move(difference));
+}
+
+void
+simplex_master::replace_basic_variable(unsigned slot, unsigned variable)
+{
+    basic_variables[slot] = variable;
+    std::vector<double> column(basic_variables.size());
+    column_of(variable, column);
+    update_column(slot, std::move(column));
+}
+
+void
+simplex_master::grow_basis(unsigned variable, unsigned row)
+{
+    // an unused pair of positions has the column e_a and the row e_b^T
+    if (free_slots.empty()) {
+        free_slots.emplace_back(tight_rows.size(), basic_variables.size());
+        tight_rows.push_back(no_slot);
+        basic_variables.push_back(no_slot);
+    }
+    const auto [a, b] = free_slots.back();
+    free_slots.pop_back();
+
+    const unsigned k = basic_variables.size();
+    tight_rows[a] = row;
+    row_slot[row] = a;
+    basic_variables[b] = variable;
+    std::vector<double> column(k);
+    column_of(variable, column);
+    update_column(b, std::move(column));
+
+    // row a only has the new entry at b so far
+    std::vector<double> difference(k);
+    row_of(row, difference);
+    difference[b] = 0.0;
+    update_row(a, std::move(difference));
+}
+
+void
+simplex_master::shrink_basis(unsigned row_position, unsigned column_position)
+{
+    const unsigned k = basic_variables.size();
+    std::vector<double> column(k, 0.0);
+    column[row_position] = 1.0;
+    update_column(column_position, std::move(column));
+
+    // clear the old row except for the one at column_position
+    std::vector<double> difference(k);
+    row_of(tight_rows[row_position], difference);
+    for (double& d : difference) {
+        d = -d;
+    }
+    difference[column_position] = 0.0;
+    update_row(row_position, std::move(difference));
+
+    row_slot[tight_rows[row_position]] = no_slot;
+    tight_rows[row_position] = no_slot;
+    basic_variables[column_position] = no_slot;
+    free_slots.emplace_back(row_position, column_position);
+}
+
+void
+simplex_master::update_row(unsigned slot, std::vector<double> difference)
+{
+    if (stale_factorisation) {
+        return;
+    }
+    // B' = B + e_slot difference^T = (I + e_slot u^T) B with B^T u = difference
+    solve_transposed(difference);
+    eta e{ true, slot, 1.0 + difference[slot], {} };
+    if (std::abs(e.pivot) <= pivot_tolerance) {
+        stale_factorisation = true;
+        return;
+    }
+    for (unsigned a = 0; a < difference.size(); a++) {
+        if (difference[a] != 0.0) {
+            e.values.emplace_back(a, difference[a]);
+        }
+    }
+    etas.push_back(std::move(e));
+}
+
+void
+simplex_master::update_column(unsigned slot, std::vector<double> column)
+{
+    if (stale_factorisation) {
+        return;
+    }
+    // B' = B (I + (h - e_slot) e_slot^T) with B h = column
+    solve(column);
+    eta e{ false, slot, column[slot], {} };
+    if (std::abs(e.pivot) <= pivot_tolerance) {
+        stale_factorisation = true;
+        return;
+    }
+    for (unsigned a = 0; a < column.size(); a++) {
+        if (a != slot && column[a] != 0.0) {
+            e.values.emplace_back(a, column[a]);
+        }
+    }
+    etas.push_back(std::move(e));
+}
+
+void
+simplex_master::factorise()
+{
+    // drop the unused positions, they always come in pairs.
+    auto used = [](unsigned i) { return i != no_slot; };
+    basic_variables.erase(std::stable_partition(basic_variables.begin(),
+                                                basic_variables.end(),
+                                                used),
+                          basic_variables.end());
+    tight_rows.erase(
+      std::stable_partition(tight_rows.begin(), tight_rows.end(), used),
+      tight_rows.end());
+    assert(basic_variables.size() == tight_rows.size());
+    free_slots.clear();
+    etas.clear();
+    lu.clear();
+    stale_factorisation = false;
+
+    const unsigned k = basic_variables.size();
+    factorised_size = k;
+    for (unsigned a = 0; a < k; a++) {
+        row_slot[tight_rows[a]] = a;
+    }
+
+    // sparse columns of A_{T,K}, eliminated from the sparsest one (left-looking, partial pivoting)
+    std::vector<sparse_vector> columns(k);
+    std::vector<double> x(k, 0.0);
+    for (unsigned b = 0; b < k; b++) {
+        column_of(basic_variables[b], x);
+        for (unsigned a = 0; a < k; a++) {
+            if (x[a] != 0.0) {
+                columns[b].emplace_back(a, x[a]);
+            }
+        }
+    }
+    std::vector<unsigned> order(k);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](unsigned l, unsigned r) {
+        return columns[l].size() < columns[r].size();
+    });
+
+    std::vector<bool> eliminated(k, false);
+    std::vector<unsigned> singular_columns;
+    for (unsigned b : order) {
+        std::fill(x.begin(), x.end(), 0.0);
+        for (auto [a, value] : columns[b]) {
+            x[a] = value;
+        }
+        for (const lu_step& s : lu) {
+            const double pivot_value = x[s.row];
+            if (pivot_value == 0.0) {
+                continue;
+            }
+            for (auto [a, l] : s.lower) {
+                x[a] -= l * pivot_value;
+            }
+        }
+
+        unsigned pivot = k;
+        for (unsigned a = 0; a < k; a++) {
+            if (!eliminated[a] &&
+                (pivot == k || std::abs(x[a]) > std::abs(x[pivot]))) {
+                pivot = a;
+            }
+        }
+        if (pivot == k || std::abs(x[pivot]) <= pivot_tolerance) {
+            singular_columns.push_back(b);
+            continue;
+        }
+
+        lu_step s{ pivot, b, x[pivot], {}, {} };
+        for (unsigned a = 0; a < k; a++) {
+            if (a == pivot || x[a] == 0.0) {
+                continue;
+            }
+            if (eliminated[a]) {
+                s.upper.emplace_back(a, x[a]);
+            } else {
+                s.lower.emplace_back(a, x[a] / s.pivot);
+            }
+        }
+        eliminated[pivot] = true;
+        lu.push_back(std::move(s));
+    }
+
+    if (singular_columns.empty()) {
+        return;
+    }
+
+    // replace every dependent column by the slack of a row that got no pivot.
+    if (verbose) {
+        output << " ====(Master)==== Repaired singular basis, "
+               << singular_columns.size() << " columns replaced by slacks"
+               << std::endl;
+    }
+    choose_slacks = true;
+    unsigned a = 0;
+    for (unsigned b : singular_columns) {
+        while (eliminated[a]) {
+            a++;
+        }
+        primal[basic_variables[b]] = 0.0;
+        basic_variables[b] = no_slot;
+        row_slot[tight_rows[a]] = no_slot;
+        tight_rows[a] = no_slot;
+        a++;
+    }
+    factorise();
+}
+
+void
+simplex_master::solve_factorised(std::vector<double>& rhs) const
+{
+    // L
+    for (const lu_step& s : lu) {
+        const double pivot_value = rhs[s.row];
+        if (pivot_value == 0.0) {
+            continue;
+        }
+        for (auto [a, l] : s.lower) {
+            rhs[a] -= l * pivot_value;
+        }
+    }
+    // U, maps the row positions to the column positions
+    std::vector<double> x(rhs.size());
+    std::copy(rhs.begin() + factorised_size, rhs.end(), x.begin() + factorised_size);
+    for (auto s = lu.rbegin(); s != lu.rend(); ++s) {
+        const double value = rhs[s->row] / s->pivot;
+        x[s->column] = value;
+        for (auto [a, u] : s->upper) {
+            rhs[a] -= u * value;
+        }
+    }
+    rhs = std::move(x);
+}
+
+void
+simplex_master::solve_factorised_transposed(std::vector<double>& rhs) const
+{
+    // U^T, maps the column positions to the row positions
+    std::vector<double> x(rhs.size());
+    std::copy(rhs.begin() + factorised_size, rhs.end(), x.begin() + factorised_size);
+    for (const lu_step& s : lu) {
+        double value = rhs[s.column];
+        for (auto [a, u] : s.upper) {
+            value -= u * x[a];
+        }
+        x[s.row] = value / s.pivot;
+    }
+    // L^T
+    for (auto s = lu.rbegin(); s != lu.rend(); ++s) {
+        for (auto [a, l] : s->lower) {
+            x[s->row] -= l * x[a];
+        }
+    }
+    rhs = std::move(x);
+}
+
+void
+simplex_master::solve(std::vector<double>& rhs) const
+{
+    // B = E_r ... E_1 B_0 F_1 ... F_s
+    for (auto e = etas.rbegin(); e != etas.rend(); ++e) {
+        if (e->row) {
+            double dot = 0.0;
+            for (auto [a, u] : e->values) {
+                dot += u * rhs[a];
+            }
+            rhs[e->slot] -= dot / e->pivot;
+        }
+    }
+    solve_factorised(rhs);
+    for (const eta& e : etas) {
+        if (!e.row) {
+            const double value = rhs[e.slot] / e.pivot;
+            for (auto [a, h] : e.values) {
+                rhs[a] -= h * value;
+            }
+            rhs[e.slot] = value;
+        }
+    }
+}
+
+void
+simplex_master::solve_transposed(std::vector<double>& rhs) const
+{
+    for (auto e = etas.rbegin(); e != etas.rend(); ++e) {
+        if (!e->row) {
+            double value = rhs[e->slot];
+            for (auto [a, h] : e->values) {
+                value -= h * rhs[a];
+            }
+            rhs[e->slot] = value / e->pivot;
+        }
+    }
+    solve_factorised_transposed(rhs);
+    for (const eta& e : etas) {
+        if (e.row) {
+            const double value = rhs[e.slot] / e.pivot;
+            for (auto [a, u] : e.values) {
+                rhs[a] -= u * value;
+            }
+        }
+    }
+}
+
+double
+simplex_master::objective() const
+{
+    double sum = 0.0;
+    for (double r : residual) {
+        sum += std::abs(r);
+    }
+    return sum;
+}
@@ -0,0 +1,239 @@
+#ifndef SIMPLEX_MASTER_H
+#define SIMPLEX_MASTER_H
+
+#include "arr.h"
+#include "coordinates.h"
+#include "exception.h"
+#include "master.h"
+#include "stop_watch.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <list>
+#include <numeric>
+#include <optional>
+#include <utility>
+#include <vector>
+
+///@brief A master_problem implementation that does not need Gurobi.
+///
+/// Uses that every row has its own pair of slack variables: the master is min sum_r |m_r - (Ax)_r| with x >= 0.
+/// A basis consists of k columns K and k tight rows T (residual 0), all other rows have exactly one basic slack.
+/// Therefore only the k x k matrix A_{T,K} has to be factorised, while the ratio test passes through the kinks of |.|
+/// as long as the objective keeps decreasing (long step).
+/// The sparse LU-decomposition of A_{T,K} is updated in product form after every pivot and only recomputed every
+/// max_updates pivots. A singular basis is repaired by replacing its dependent columns with slacks.
+/// The basis is kept between calls, so re-solves after add_variable and clean start from the last optimal basis.
+/// The duals have the same layout and sign as the ones of grb_master.
+class simplex_master : public master_problem
+{
+  public:
+    simplex_master(bool verbose,
+                   std::ostream& output,
+                   solver s,
+                   double master_solution_threshold);
+    ~simplex_master() override;
+
+    /// One variable of the master: a shifted reference for every sender-receiver-pair.
+    struct sparse_column
+    {
+        /// Contiguous nonzero rows [row, row + length) with values starting at values[value].
+        struct segment
+        {
+            unsigned row;
+            unsigned length;
+            unsigned value;
+        };
+
+        std::vector<segment> segments;
+        std::vector<double> values;
+
+        /// Returns A_{row, this}.
+        double at(unsigned row) const;
+        /// Returns the dot product with the dense vector dense.
+        double dot(const std::vector<double>& dense) const;
+        /// Computes dense += factor * this.
+        void add_to(double factor, std::vector<double>& dense) const;
+    };
+
+    /// Masterclean : variables having an value < threshold are automatically removed from the master.
+    double threshold;
+
+    /// The columns of the master, same order as name2tof.
+    std::vector<sparse_column> variables;
+    /// Values of the variables.
+    std::vector<double> primal;
+
+    /// The flattened measurement (same layout as the duals).
+    std::vector<double> measurement_values;
+    /// The flattened measurement minus the simulation of all variables.
+    std::vector<double> residual;
+    /// The dual values y.
+    std::vector<double> dual;
+    /// +1 or -1 : Sign of the basic slack of a non-tight row (equals the dual value of that row).
+    std::vector<int> side;
+
+    /// Marks unused positions in basic_variables and tight_rows.
+    static constexpr unsigned no_slot = std::numeric_limits<unsigned>::max();
+
+    /// The basic variables K (indexes into variables), no_slot for unused positions.
+    std::vector<unsigned> basic_variables;
+    /// The tight rows T, basic_variables and tight_rows always have the same size.
+    std::vector<unsigned> tight_rows;
+    /// Position of every row in tight_rows, no_slot for rows that are not tight.
+    std::vector<unsigned> row_slot;
+    /// Unused positions (in tight_rows, in basic_variables), the basis matrix has a one at both positions.
+    std::vector<std::pair<unsigned, unsigned>> free_slots;
+
+    /// Sparse vector of (position, value).
+    using sparse_vector = std::vector<std::pair<unsigned, double>>;
+
+    /// One column of the sparse LU-decomposition of the basis matrix.
+    struct lu_step
+    {
+        /// Pivot position in tight_rows and in basic_variables.
+        unsigned row, column;
+        double pivot;
+        /// Multipliers for the rows that were not eliminated before (L).
+        sparse_vector lower;
+        /// Entries in the rows that were eliminated before (U without the pivot).
+        sparse_vector upper;
+    };
+
+    /// A rank one update of the basis matrix since the last factorisation.
+    struct eta
+    {
+        /// True for B' = (I + e_slot u^T) B (a replaced row), false for B' = B (I + (h - e_slot) e_slot^T).
+        bool row;
+        unsigned slot;
+        /// 1 + u_slot for a row, h_slot for a column.
+        double pivot;
+        /// u for a row, h without the pivot for a column.
+        sparse_vector values;
+    };
+
+    /// LU-decomposition of the basis matrix at the last factorisation, in elimination order.
+    std::vector<lu_step> lu;
+    /// Positions that were added after the last factorisation start as identity.
+    unsigned factorised_size;
+    /// Updates since the last factorisation, in order.
+    std::vector<eta> etas;
+    /// Set when an update was rejected as numerically unstable.
+    bool stale_factorisation;
+    /// Set when the basis was repaired or crashed, recompute_primal then chooses the slacks by the sign of the residual.
+    bool choose_slacks;
+
+    /// Simplex iterations done in the last solve.
+    unsigned iterations;
+
+    unsigned senders, receivers, measurement_samples, offset;
+    bool started;
+
+    /// The solver argument is ignored, this master always uses the primal simplex.
+    virtual void solve_reduced_problem(
+      int elements,
+      unsigned offset,
+      arr<>& measurement,
+      arr<>& reference_signal,
+      std::optional<solver> enforce_particular_solver,
+      dual_solution& out,
+      double& obj) override;
+
+    /// Adds the variable as nonbasic, the last basis stays optimal for the primal. warm_start_value is ignored.
+    virtual void add_variable(time_of_flight& variable,
+                              const arr<>& reference_signal,
+                              std::optional<double> warm_start_value) override;
+
+    virtual void get_primal(std::vector<double>& primal_values) override;
+
+    virtual void get_primal(std::vector<double>& primal_values,
+                            arr<>& pos_slack,
+                            arr<>& neg_slack) override;
+
+    virtual unsigned clean() override;
+
+    /// The next solve starts from a basis crashed from primal_values, the duals are computed from that basis.
+    virtual void set_warm_start(const std::vector<double>& primal_values,
+                                const arr<>& duals) override;
+
+    /// Creates the all slack basis, will be called automatically on start.
+    virtual void set_start_variables(arr<>& measurement);
+
+  protected:
+    /// A possible improving direction of the simplex.
+    struct candidate
+    {
+        /// True when a tight row leaves T, false when a variable enters K.
+        bool release;
+        /// Index of the entering variable or position of the released row in tight_rows.
+        unsigned index;
+        /// Direction of the released row residual.
+        int sigma;
+        /// Slope of the objective when moving into this direction.
+        double reduced_cost;
+    };
+
+    /// Dense direction of the residual, only nonzero in touched_rows.
+    std::vector<double> residual_direction;
+    /// Rows having a nonzero residual_direction.
+    std::vector<unsigned> touched_rows;
+    /// True for rows in touched_rows.
+    std::vector<bool> touched;
+    /// Direction of the basic variables.
+    std::vector<double> basic_direction;
+    /// Breakpoints (step length, row) of the ratio test.
+    std::vector<std::pair<double, unsigned>> breakpoints;
+    /// The warm start of the next solve.
+    std::optional<std::vector<double>> warm_start_primal;
+
+    /// @brief Chooses a basis from warm_start_primal.
+    ///
+    /// Every positive variable of the warm start becomes basic together with the row of its column that has the
+    /// smallest warm start residual, variables that become negative leave the basis again.
+    void crash_basis();
+
+    /// Recomputes the basic variables and the residual from scratch.
+    void recompute_primal();
+    /// Computes the duals for the current basis.
+    void compute_duals();
+    /// Finds an improving direction, returns false if the basis is optimal.
+    bool price(candidate& c, bool smallest_index);
+    /// Computes basic_direction and residual_direction for c.
+    void compute_direction(const candidate& c);
+    /// Adds factor * v to residual_direction.
+    void add_to_direction(double factor, const sparse_column& v);
+    /// Does the ratio test and updates the basis, returns the step length.
+    double step(const candidate& c);
+
+    /// The entries of variable in the tight rows, by position.
+    void column_of(unsigned variable, std::vector<double>& out) const;
+    /// The entries of the basic variables in row, by position.
+    void row_of(unsigned row, std::vector<double>& out) const;
+    /// Tight row at position slot is replaced by row.
+    void replace_tight_row(unsigned slot, unsigned row);
+    /// Basic variable at position slot is replaced by variable.
+    void replace_basic_variable(unsigned slot, unsigned variable);
+    /// Variable and row join the basis.
+    void grow_basis(unsigned variable, unsigned row);
+    /// Positions row_position and column_position leave the basis.
+    void shrink_basis(unsigned row_position, unsigned column_position);
+    /// Adds the eta of a replaced row (difference = new row - old row) or of a replaced column.
+    void update_row(unsigned slot, std::vector<double> difference);
+    void update_column(unsigned slot, std::vector<double> column);
+
+    /// Compacts the basis and factorises it from scratch, dependent columns are replaced by slacks.
+    void factorise();
+    /// Solves B x = rhs in place, with the last factorisation only.
+    void solve_factorised(std::vector<double>& rhs) const;
+    void solve_factorised_transposed(std::vector<double>& rhs) const;
+    /// Solves A_{T,K} x = rhs in place.
+    void solve(std::vector<double>& rhs) const;
+    /// Solves A_{T,K}^T x = rhs in place.
+    void solve_transposed(std::vector<double>& rhs) const;
+
+    /// Objective of the current basis.
+    double objective() const;
+};
+
+#endif
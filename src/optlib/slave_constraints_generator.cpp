@@ -1,10 +1,57 @@
 #include "slave_constraints_generator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+/// a * x + b.
+struct linear_function
+{
+    double a, b;
+    double operator()(double x) const { return a * x + b; }
+};
+
+/// Smallest and largest value of sqrt(max(u(x), 0)) + sqrt(max(v(x), 0)) for x in [start, end].
+std::pair<double, double>
+sum_of_roots_extremes(linear_function u,
+                      linear_function v,
+                      double start,
+                      double end)
+{
+    // between the roots of u and v the sum is monotone or concave, so its extremes lie on the boundary or where the
+    // derivatives u.a / 2sqrt(u) and v.a / 2sqrt(v) cancel, which is u.a^2 * v = v.a^2 * u.
+    std::vector<double> xs{ start, end };
+    for (const linear_function& w : { u, v }) {
+        if (w.a != 0.0) {
+            xs.push_back(-w.b / w.a);
+        }
+    }
+    if (u.a * v.a < 0.0) {
+        xs.push_back((v.a * v.a * u.b - u.a * u.a * v.b) /
+                     (u.a * v.a * (u.a - v.a)));
+    }
+    std::pair<double, double> extremes{ std::numeric_limits<double>::infinity(),
+                                        -std::numeric_limits<double>::infinity() };
+    for (const double x : xs) {
+        if (x < start || x > end) {
+            continue;
+        }
+        const double value = std::sqrt(std::max(u(x), 0.0)) +
+                             std::sqrt(std::max(v(x), 0.0));
+        extremes.first = std::min(extremes.first, value);
+        extremes.second = std::max(extremes.second, value);
+    }
+    return extremes;
+}
+}
 
 void
 slave_constraint_generator::all(callback callback)
 {
     diameter_definition(callback);
-    diameter_equality(callback);
+    if (!only_diagonal) {
+        diameter_equality(callback);
+    }
     quadratic_definition(callback);
     quadratic_equality(callback);
 
@@ -102,7 +149,7 @@ slave_constraint_generator::diameter_definition(callback callback)
     callback(d_0 >= -1.0 * x);
 
     for (unsigned i = 0; i < f.dim1; i++) {
-        for (unsigned j = i; j < f.dim1; j++) {
+        for (unsigned j = i; j < (only_diagonal ? i + 1 : f.dim1); j++) {
             linear_expression lower =
               lef::create_binary_sum(
                 i, j, slave_mapping.to_distance, binary_sum::DISTANCE) -
@@ -195,10 +242,115 @@ void
 slave_constraint_generator::binary_sum_to_one(callback callback)
 {
     for (unsigned i = 0; i < f.dim1; i++) {
-        for (unsigned j = i; j < f.dim2; j++) {
+        for (unsigned j = i; j < (only_diagonal ? i + 1 : f.dim2); j++) {
             linear_expression sum = lef::create_binary_sum(
               i, j, slave_mapping.to_distance, binary_sum::SUM);
             callback(sum == 1.0);
         }
     }
 }
+
+std::vector<std::pair<unsigned, unsigned>>
+slave_constraint_generator::reachable_k_ranges(double x_start,
+                                               double x_end) const
+{
+    const unsigned elements = f.dim1;
+    const unsigned samples = f.dim3;
+    const unsigned pairs = elements * (elements + 1) / 2;
+    std::vector<std::pair<unsigned, unsigned>> ranges(pairs, { 0, samples - 1 });
+
+    const double min_distance = slave_mapping.to_distance(0);
+    const double max_distance = slave_mapping.to_distance(samples - 1);
+    // (D - 0.5)^2 - 0.5 <= q <= (D + 0.5)^2 for the distance D of the chosen binary, the lower bound is smallest at 0.5.
+    const double q_min = std::pow(std::max(min_distance - 0.5, 0.0), 2) - 0.5;
+    const double q_max = std::pow(max_distance + 0.5, 2);
+    // |x| <= d_0 <= D_0 + 0.5.
+    x_start = std::max(x_start, -max_distance - 0.5);
+    x_end = std::min(x_end, max_distance + 0.5);
+    if (x_start > x_end) {
+        // no feasible x, keep the pairs unrestricted instead of making the slave infeasible.
+        return ranges;
+    }
+
+    std::vector<double> position(elements);
+    for (unsigned e = 0; e < elements; e++) {
+        position[e] = 2.0 * e * pitch;
+    }
+    // the nearest element only changes at the midpoints of neighbouring elements, the farthest one at the middle.
+    std::vector<double> cuts{ 0.5 * (position.front() + position.back()) };
+    for (unsigned e = 0; e + 1 < elements; e++) {
+        cuts.push_back(0.5 * (position[e] + position[e + 1]));
+    }
+    cuts.erase(std::remove_if(cuts.begin(),
+                              cuts.end(),
+                              [&](double x) { return x <= x_start || x >= x_end; }),
+               cuts.end());
+    cuts.push_back(x_start);
+    cuts.push_back(x_end);
+    std::sort(cuts.begin(), cuts.end());
+
+    std::vector<double> lower(pairs, std::numeric_limits<double>::infinity());
+    std::vector<double> upper(pairs, -std::numeric_limits<double>::infinity());
+    for (unsigned c = 0; c + 1 < cuts.size(); c++) {
+        const double start = cuts[c];
+        const double end = cuts[c + 1];
+        const double middle = 0.5 * (start + end);
+        unsigned nearest = 0;
+        for (unsigned e = 1; e < elements; e++) {
+            if (std::fabs(middle - position[e]) <
+                std::fabs(middle - position[nearest])) {
+                nearest = e;
+            }
+        }
+        const unsigned farthest =
+          middle - position.front() >= position.back() - middle ? 0
+                                                                : elements - 1;
+        // s = q_e - (x - p_e)^2 is the same for all e, so q_min - (x - p_nearest)^2 <= s <= q_max - (x - p_farthest)^2
+        // and q_e is bounded by q + (x - p_e)^2 - (x - p_to)^2, which is linear in x.
+        auto shifted = [&](unsigned e, unsigned to, double q) {
+            return linear_function{ -2.0 * (position[e] - position[to]),
+                                    q + position[e] * position[e] -
+                                      position[to] * position[to] };
+        };
+
+        unsigned p = 0;
+        for (unsigned i = 0; i < elements; i++) {
+            for (unsigned j = i; j < elements; j++, p++) {
+                // sqrt(q_e) - 0.5 <= D_e <= sqrt(q_e + 0.5) + 0.5, and 2 * d_ij = d_ii + d_jj adds 1 off the diagonal.
+                const double rounding = i == j ? 0.5 : 1.5;
+                const double shortest =
+                  sum_of_roots_extremes(shifted(i, nearest, q_min),
+                                        shifted(j, nearest, q_min),
+                                        start,
+                                        end)
+                    .first;
+                const double longest =
+                  sum_of_roots_extremes(shifted(i, farthest, q_max + 0.5),
+                                        shifted(j, farthest, q_max + 0.5),
+                                        start,
+                                        end)
+                    .second;
+                lower[p] = std::min(lower[p], 0.5 * shortest - rounding);
+                upper[p] = std::max(upper[p], 0.5 * longest + rounding);
+            }
+        }
+    }
+
+    // only absorbs the floating point error of the square roots.
+    const double tolerance = 1e-6;
+    for (unsigned p = 0; p < pairs; p++) {
+        unsigned first = 0, last = samples - 1;
+        while (first < samples &&
+               slave_mapping.to_distance(first) < lower[p] - tolerance) {
+            first++;
+        }
+        while (last > first &&
+               slave_mapping.to_distance(last) > upper[p] + tolerance) {
+            last--;
+        }
+        if (first < samples) {
+            ranges[p] = { first, last };
+        }
+    }
+    return ranges;
+}
@@ -6,6 +6,8 @@
 #include "linear_expression.h"
 #include "slave_problem.h"
 #include <functional>
+#include <utility>
+#include <vector>
 
 /// Generates the slaves constraints. Does not depend on a certain LP-Solverframework.
 struct slave_constraint_generator
@@ -25,9 +27,23 @@ struct slave_constraint_generator
     /// Used to assert that not diameter_inequality and diameter_equality are used together.
     std::optional<bool> rounded_down_non_diameters;
 
+    /// Only generates the constraints of the diagonal (i == j), for slaves without off-diagonal binaries and diameters.
+    bool only_diagonal = false;
+
     /// Generates all needed constraints.
     void all(callback callback);
 
+    /// @brief Smallest and largest k of every sender-receiver-pair i <= j (row by row) that the constraints allow for a representant x in [x_start, x_end].
+    ///
+    /// Only uses the rounding of diameter_definition and quadratic_definition, quadratic_equality, diameter_equality and
+    /// d_0 >= |x|, so a binary outside of its range is 0 in every feasible solution. With s = q_0 - x^2, every
+    /// q_e = (x - p_e)^2 + s lies in [(D_min - 0.5)^2 - 0.5, (D_max + 0.5)^2], which bounds s by the nearest and the
+    /// farthest element. Both bounds are linear in x between the midpoints of the elements, and the distances of a pair
+    /// are sums of square roots of them there, whose extremes are found in closed form.
+    std::vector<std::pair<unsigned, unsigned>> reachable_k_ranges(
+      double x_start,
+      double x_end) const;
+
   protected:
     /// Generates all n^2 constraints \sum_k (k \cdot b_ijk) <= d_ij <= \sum_k ((k+1) \cdot b_ijk) from the binaries and calls the callback for every one of them. Also creates d_0 >= x and d_0 >= -x.
     void diameter_definition(callback callback);
@@ -0,0 +1,110 @@
+#include "slave_portfolio.h"
+
+slave_portfolio::slave_portfolio(std::vector<slave_configuration> configurations,
+                                 unsigned min_runs,
+                                 double kill_ratio)
+  : configurations(std::move(configurations))
+  , stats(this->configurations.size())
+  , min_runs(min_runs)
+  , kill_ratio(kill_ratio)
+{
+    assert(!this->configurations.empty() && "Empty portfolio!");
+}
+
+double
+slave_portfolio::performance::rate() const
+{
+    return columns / std::max(seconds, 1e-3);
+}
+
+unsigned
+slave_portfolio::start()
+{
+    std::optional<unsigned> best;
+    // try every configuration min_runs times first.
+    for (unsigned c = 0; c < stats.size(); c++) {
+        const performance& p = stats[c];
+        if (!p.killed && p.runs + p.active < min_runs &&
+            (!best || p.runs + p.active <
+                        stats[*best].runs + stats[*best].active)) {
+            best = c;
+        }
+    }
+    if (!best) {
+        double best_score = -1.0;
+        for (unsigned c = 0; c < stats.size(); c++) {
+            const performance& p = stats[c];
+            const double score = p.rate() / (1 + p.active);
+            if (!p.killed && score > best_score) {
+                best_score = score;
+                best = c;
+            }
+        }
+    }
+    assert(best && "All configurations killed!");
+    stats[*best].active++;
+    return *best;
+}
+
+void
+slave_portfolio::finish(unsigned configuration,
+                        unsigned columns,
+                        double seconds)
+{
+    performance& p = stats[configuration];
+    assert(p.active > 0);
+    p.active--;
+    p.runs++;
+    p.columns += columns;
+    p.seconds += seconds;
+    prune();
+}
+
+bool
+slave_portfolio::killed(unsigned configuration) const
+{
+    return stats[configuration].killed;
+}
+
+void
+slave_portfolio::prune()
+{
+    double best_rate = 0.0;
+    for (const performance& p : stats) {
+        if (p.runs >= min_runs) {
+            best_rate = std::max(best_rate, p.rate());
+        }
+    }
+    // the best configuration is never killed as its rate is not smaller than itself.
+    for (performance& p : stats) {
+        if (p.runs >= min_runs && p.rate() < kill_ratio * best_rate) {
+            p.killed = true;
+        }
+    }
+}
+
+std::vector<slave_configuration>
+slave_portfolio::default_configurations(slave_cut_options cuts, int options)
+{
+    std::vector<slave_cut_options> all_cuts{ slave_cut_options::OFF };
+    if (cuts != slave_cut_options::OFF) {
+        all_cuts.push_back(cuts);
+    }
+    std::vector<int> all_options{ 0 };
+    if (options != 0) {
+        all_options.push_back(options);
+    }
+
+    std::vector<slave_configuration> configurations;
+    int seed = 0;
+    for (slave_cut_options c : all_cuts) {
+        for (int o : all_options) {
+            for (std::optional<double> gap :
+                 { std::optional<double>{}, std::optional<double>{ 0.5 },
+                   std::optional<double>{ 0.25 } }) {
+                configurations.push_back({ c, o, seed++, gap });
+            }
+        }
+    }
+    return configurations;
+}
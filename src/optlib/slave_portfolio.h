@@ -0,0 +1,72 @@
+#ifndef SLAVE_PORTFOLIO_H
+#define SLAVE_PORTFOLIO_H
+
+#include "cut_helper.h"
+#include <algorithm>
+#include <cassert>
+#include <optional>
+#include <vector>
+
+/// A parameter set of an async slave.
+struct slave_configuration
+{
+    slave_cut_options cuts;
+    /// Combination of slave_callback_options.
+    int options;
+    /// Gurobi seed.
+    int seed;
+    /// The slave can be interrupted when its MIPGap is smaller, cf. grb_slave_async::max_allowed_gap.
+    std::optional<double> max_allowed_gap;
+};
+
+///@brief Learns which slave_configuration finds columns fastest.
+///
+/// Every finished (or interrupted) slave run is recorded with the number of columns it found and its runtime.
+/// Idle slaves get the configuration with the best columns per second, divided by the number of slaves already
+/// running it so that the slots spread over the good configurations. Configurations that were run less than min_runs
+/// times are tried first, configurations with less than kill_ratio times the best rate after min_runs are killed:
+/// they are not chosen anymore and slaves running them may be interrupted.
+class slave_portfolio
+{
+  public:
+    slave_portfolio(std::vector<slave_configuration> configurations,
+                    unsigned min_runs = 2,
+                    double kill_ratio = 0.25);
+
+    /// Statistics of one configuration.
+    struct performance
+    {
+        unsigned runs = 0;
+        unsigned columns = 0;
+        double seconds = 0.0;
+        /// Number of slaves currently running the configuration.
+        unsigned active = 0;
+        bool killed = false;
+
+        /// Columns per second.
+        double rate() const;
+    };
+
+    std::vector<slave_configuration> configurations;
+    std::vector<performance> stats;
+    unsigned min_runs;
+    double kill_ratio;
+
+    /// Returns the configuration for an idle slave and marks it active.
+    unsigned start();
+    /// Records a run of configuration that found columns in seconds and marks it inactive.
+    void finish(unsigned configuration, unsigned columns, double seconds);
+    /// True if slaves with this configuration should be interrupted.
+    bool killed(unsigned configuration) const;
+
+    /// Cross product of {OFF, cuts} and {0, options} with the gaps unbounded, 50% and 25%, every configuration has its own seed.
+    static std::vector<slave_configuration> default_configurations(
+      slave_cut_options cuts,
+      int options);
+
+  protected:
+    /// Kills the configurations that are too slow compared to the best one.
+    void prune();
+};
+
+#endif
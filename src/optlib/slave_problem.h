@@ -56,6 +56,8 @@ class slave_problem
 
     /// Ask the slave to print its logs.
     virtual void print(bool force){};
+    /// Seconds all solvers of the slave spent solving so far, 0 when not tracked.
+    virtual double busy_time() { return 0.0; };
 
     virtual ~slave_problem(){};
 };
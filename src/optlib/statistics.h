@@ -2,6 +2,7 @@
 #define STATISTICS_H
 
 #include "csv_tools.h"
+#include <algorithm>
 #include <chrono>
 #include <vector>
 
@@ -30,6 +31,8 @@ struct slave_statistics
     unsigned total_old_slave_solutions = 0;
     unsigned solutions_in_pool = 0;
     unsigned actual_slave_id = 0;
+    unsigned pool_evictions = 0;
+    unsigned pool_hits = 0;
 };
 
 /// Same as slave_statistics but for the master.
@@ -38,8 +41,22 @@ struct master_statistics
     double objective;
     double elapsed_run_time;
     double explored_node_count;
+
+    ///Filled by the column generation.
+    double lower_bound = 0.0;
+    double gap = 1.0;
 };
 
+/// Returns the gap between upper and lower bound relative to upper.
+inline double
+relative_gap(double upper, double lower)
+{
+    if (upper <= 0.0) {
+        return 0.0;
+    }
+    return std::max(0.0, upper - lower) / upper;
+}
+
 /// Collection of master_statistics and slave_statistics. Dumps the information to disk.
 struct statistics
 {
@@ -51,6 +68,10 @@ struct statistics
     std::vector<double> master_time;
     /// (Total) Slave runtime per Iteration.
     std::vector<double> slave_time;
+    /// Seconds the master waited for columns per Iteration (async only).
+    std::vector<double> master_wait_time;
+    /// Seconds all async slaves together spent solving per Iteration (async only).
+    std::vector<double> slave_busy_time;
 
     /// Add slave_statistic for next master-run.
     void add_statistic_for_next_master(slave_statistics s)
@@ -72,13 +93,18 @@ struct statistics
     {
         if (master_runs.size() == 1) {
             master_stream << "#objective;elapsed_run_time;explored_node_count;"
+                             "lower_bound;gap;"
                           << std::endl;
-            time_stream << "#master_time;slave_time" << std::endl;
+            time_stream << "#master_time;slave_time;master_wait_time;slave_"
+                           "busy_time"
+                        << std::endl;
         }
         master_statistics& m = master_runs.back();
         insert_with_semicolon(master_stream, m.objective);
         insert_with_semicolon(master_stream, m.elapsed_run_time);
         insert_with_semicolon(master_stream, m.explored_node_count);
+        insert_with_semicolon(master_stream, m.lower_bound);
+        insert_with_semicolon(master_stream, m.gap);
         master_stream << std::endl;
 
         if (slave_runs.size() == 1) {
@@ -86,7 +112,8 @@ struct statistics
                             "objective;best_objective_"
                             "bound;explored_node_count;feasible_solutions_"
                             "count;used_old_slave_solutions;total_old_"
-                            "slave_solutions;solutions_in_pool"
+                            "slave_solutions;solutions_in_pool;actual_slave_id;pool_"
+                            "evictions;pool_hits"
                          << std::endl;
         }
 
@@ -105,12 +132,18 @@ struct statistics
             insert_with_semicolon(slave_stream, s.total_old_slave_solutions);
             insert_with_semicolon(slave_stream, s.solutions_in_pool);
             insert_with_semicolon(slave_stream, s.actual_slave_id);
+            insert_with_semicolon(slave_stream, s.pool_evictions);
+            insert_with_semicolon(slave_stream, s.pool_hits);
             slave_stream << std::endl;
         }
 
         insert_with_semicolon(time_stream, master_time.back());
         double current_slave_time = slave_time.empty() ? 0 : slave_time.back();
         insert_with_semicolon(time_stream, current_slave_time);
+        insert_with_semicolon(
+          time_stream, master_wait_time.empty() ? 0 : master_wait_time.back());
+        insert_with_semicolon(
+          time_stream, slave_busy_time.empty() ? 0 : slave_busy_time.back());
 
         time_stream << std::endl;
     }
@@ -0,0 +1,104 @@
+#include "strip_decomposition.h"
+
+strip_decomposition::strip_decomposition(unsigned strips, double overlap)
+  : strips(strips)
+  , overlap(overlap)
+{
+    assert(strips > 0 && "Needs at least one strip!");
+}
+
+bool
+strip_decomposition::initialised() const
+{
+    return !_boundaries.empty();
+}
+
+void
+strip_decomposition::initialise(double start,
+                                double end,
+                                double aperture_start,
+                                double aperture_end)
+{
+    assert(start < end);
+    aperture_start = std::clamp(aperture_start, start, end);
+    aperture_end = std::clamp(aperture_end, start, end);
+
+    _boundaries.resize(strips + 1);
+    _boundaries.front() = start;
+    _boundaries.back() = end;
+    for (unsigned s = 1; s < strips; s++) {
+        _boundaries[s] =
+          aperture_start + (aperture_end - aperture_start) * s / strips;
+    }
+}
+
+std::pair<double, double>
+strip_decomposition::strip(unsigned s) const
+{
+    assert(initialised() && s < strips);
+    return { std::max(_boundaries[s] - overlap, _boundaries.front()),
+             std::min(_boundaries[s + 1] + overlap, _boundaries.back()) };
+}
+
+const std::vector<double>&
+strip_decomposition::boundaries() const
+{
+    return _boundaries;
+}
+
+void
+strip_decomposition::record(double x)
+{
+    std::unique_lock l{ mutex };
+    found_x.push_back(x);
+}
+
+void
+strip_decomposition::rebalance()
+{
+    std::unique_lock l{ mutex };
+    if (found_x.size() < strips || !initialised()) {
+        return;
+    }
+    std::sort(found_x.begin(), found_x.end());
+    for (unsigned s = 1; s < strips; s++) {
+        const double quantile =
+          std::clamp(found_x[found_x.size() * s / strips],
+                     _boundaries.front(),
+                     _boundaries.back());
+        _boundaries[s] = (1.0 - rebalance_weight) * _boundaries[s] +
+                         rebalance_weight * quantile;
+    }
+    // both the old boundaries and the quantiles are sorted, so are their convex combinations.
+    assert(std::is_sorted(_boundaries.begin(), _boundaries.end()));
+    found_x.clear();
+}
+
+void
+strip_decomposition::start(unsigned generation)
+{
+    std::unique_lock l{ mutex };
+    this->generation = generation;
+    finished = 0;
+    best.reset();
+}
+
+std::optional<column>
+strip_decomposition::finish(column&& c, unsigned generation)
+{
+    std::unique_lock l{ mutex };
+    if (generation != this->generation) {
+        return std::nullopt;
+    }
+    if (!best || c.stats.objective > best->stats.objective) {
+        best.reset();
+        best.emplace(std::move(c));
+    }
+    if (++finished < strips) {
+        return std::nullopt;
+    }
+    std::optional<column> ret;
+    ret.emplace(std::move(*best));
+    best.reset();
+    return ret;
+}
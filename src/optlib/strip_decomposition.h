@@ -0,0 +1,73 @@
+#ifndef STRIP_DECOMPOSITION_H
+#define STRIP_DECOMPOSITION_H
+
+#include "coordinates.h"
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+///@brief Splits the horizontal ROI of the slaves into overlapping strips, one slave per strip.
+///
+/// Every strip slave restricts its representant x and the k ranges of its binaries to its strip
+/// (grb_slave::restrict_to_roi), which only removes solutions outside of the strip.
+/// All strips are started together with the same dual (a generation). A strip that finishes optimally only proves
+/// optimality inside of the strip, so its final column is held back until all strips of the generation finished and
+/// the best of them is returned: as the strips cover the whole ROI, it is optimal for the whole ROI.
+/// The inner boundaries are moved towards the quantiles of the x of the columns found since the last rebalance, so
+/// that busy regions get narrower strips.
+class strip_decomposition
+{
+  public:
+    strip_decomposition(unsigned strips, double overlap);
+
+    unsigned strips;
+    /// Every strip is extended by overlap on both sides (clamped to the ROI).
+    double overlap;
+    /// Weight of the quantiles of the found columns when rebalancing, the old boundaries keep the rest.
+    double rebalance_weight = 0.5;
+
+    /// True after initialise.
+    bool initialised() const;
+
+    /// Spreads the inner boundaries uniformly over the aperture (clamped to the ROI [start, end]).
+    void initialise(double start,
+                    double end,
+                    double aperture_start,
+                    double aperture_end);
+
+    /// The bounds of the representant x of strip s.
+    std::pair<double, double> strip(unsigned s) const;
+
+    /// The boundaries of the strips without overlap (strips + 1 values).
+    const std::vector<double>& boundaries() const;
+
+    /// Remembers where a column was found.
+    void record(double x);
+
+    /// Moves the inner boundaries towards the quantiles of the recorded positions and forgets them.
+    void rebalance();
+
+    /// Starts a new generation, final columns of older generations are dropped.
+    void start(unsigned generation);
+
+    /// @brief Takes the final column of a strip slave of generation.
+    ///
+    /// Returns the best final column of the generation when it was the last strip to finish.
+    std::optional<column> finish(column&& c, unsigned generation);
+
+  protected:
+    std::vector<double> _boundaries;
+    std::vector<double> found_x;
+
+    unsigned generation = 0;
+    unsigned finished = 0;
+    std::optional<column> best;
+
+    /// Strip slaves finish and find columns concurrently.
+    std::mutex mutex;
+};
+
+#endif
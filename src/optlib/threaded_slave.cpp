@@ -0,0 +1,96 @@
+#include "threaded_slave.h"
+
+threaded_slave::threaded_slave(const slave_factory& create,
+                               constraint_pool& pool,
+                               std::ostream& output)
+  : pool(pool)
+  , output(output)
+  , slave(create(slave_output))
+{}
+
+threaded_slave::~threaded_slave()
+{
+    cancel();
+}
+
+void
+threaded_slave::run(proxy_arr<double>& f, columns& vars)
+{
+    run_async(f);
+}
+
+void
+threaded_slave::add_solution_start_hints(size size,
+                                         std::vector<time_of_flight>& hints)
+{
+    cancel();
+    slave->add_solution_start_hints(size, hints);
+}
+
+void
+threaded_slave::print(bool force)
+{
+    if (running) {
+        return;
+    }
+    std::string line;
+    while (std::getline(slave_output, line)) {
+        output << " ====(Slave) ==== " << line << std::endl;
+    }
+    slave_output.str({});
+    slave_output.clear();
+}
+
+double
+threaded_slave::busy_time()
+{
+    return busy_seconds;
+}
+
+void
+threaded_slave::run_async(proxy_arr<double>& f)
+{
+    cancel();
+    objective.realloca(f.dim1, f.dim2, f.dim3);
+    std::copy(f.begin(), f.end(), objective.begin());
+
+    const unsigned slave_id = next_slave_id++;
+    pool.set_current_slave_id(slave_id);
+    running = true;
+    thread = std::thread([this, slave_id]() {
+        stop_watch busy;
+        columns found;
+        slave->run(objective, found);
+        busy_seconds = busy_seconds + busy.elapsed();
+
+        double best = -std::numeric_limits<double>::infinity();
+        double bound = -std::numeric_limits<double>::infinity();
+        for (const column& c : found) {
+            best = std::max(best, c.stats.objective);
+            bound = std::max(bound, c.stats.best_objective_bound);
+        }
+        const auto optimality =
+          best >= bound - optimality_gap * std::abs(bound)
+            ? column::OPTIMAL
+            : column::USER_BOUND_REACHED;
+        for (column& c : found) {
+            c.optimality = optimality;
+            pool.add(std::move(c), slave_id);
+        }
+        running = false;
+    });
+}
+
+void
+threaded_slave::cancel()
+{
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool
+threaded_slave::ready()
+{
+    return !running;
+}
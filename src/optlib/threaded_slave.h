@@ -0,0 +1,73 @@
+#ifndef THREADED_SLAVE_H
+#define THREADED_SLAVE_H
+
+#include "arr.h"
+#include "constraint_pool.h"
+#include "coordinates.h"
+#include "slave_problem.h"
+#include "stop_watch.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+///@brief Runs a synchronous slave in its own thread and passes its columns to the constraint pool.
+///
+/// Lets column_generation_run_async price with the slaves that have no asynchronous mode, like geometric_slave and
+/// grb_diagonal_slave. A run can not be interrupted, cancel waits for it.
+/// The slave only returns once its run finished, so its columns are final for their dual: they are passed as OPTIMAL
+/// when the best objective reaches the bound of the run and as USER_BOUND_REACHED otherwise, the pool then passes them
+/// to the master even when they do not separate, as it does for the final columns of grb_slave_async.
+class threaded_slave
+  : public slave_problem
+  , public slave_problem_async
+{
+  public:
+    /// Creates the slave with the stream it writes to.
+    using slave_factory =
+      std::function<std::unique_ptr<slave_problem>(std::ostream&)>;
+
+    threaded_slave(const slave_factory& create,
+                   constraint_pool& pool,
+                   std::ostream& output);
+
+    ~threaded_slave() override;
+
+    constraint_pool& pool;
+    std::ostream& output;
+
+    /// Relative gap under which a run counts as optimal, the default MIPGap of Gurobi.
+    double optimality_gap = 1e-4;
+
+    /// Starts the slave on a copy of f.
+    void run(proxy_arr<double>& f, columns& vars) override;
+    void add_solution_start_hints(size size,
+                                  std::vector<time_of_flight>& hints) override;
+    /// Copies the output of the slave to output once its run finished.
+    void print(bool force) override;
+    double busy_time() override;
+
+    void run_async(proxy_arr<double>& f) override;
+    void cancel() override;
+    bool ready() override;
+
+  protected:
+    /// Written by the slave while it runs, only read when running is false.
+    std::stringstream slave_output;
+    std::unique_ptr<slave_problem> slave;
+
+    /// Copy of the objective, the caller may change f while the slave runs.
+    arr<> objective{ 0, 0, 0, nullptr };
+    unsigned next_slave_id = 1;
+
+    std::thread thread;
+    std::atomic<bool> running{ false };
+    /// Seconds spent in finished runs, only written by thread.
+    std::atomic<double> busy_seconds{ 0.0 };
+};
+
+#endif
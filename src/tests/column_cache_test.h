@@ -0,0 +1,94 @@
+#include "../optlib/column_cache.h"
+#include "../optlib/config.h"
+#include <cxxtest/TestSuite.h>
+#include <sstream>
+
+class column_cache_test : public CxxTest::TestSuite
+{
+  public:
+    void test_estimate_position()
+    {
+        config c;
+        c.elements = 8;
+        c.samples = 4000;
+        c.x_position = 0.0;
+
+        time_of_flight near(c.elements, c.elements, {});
+        c.tact_coords_to_tof(20.0, 300.0, near);
+
+        double x, y;
+        column_cache::estimate_position(c, near, x, y);
+        TS_ASSERT_DELTA(x, 20.0, 1.0);
+        TS_ASSERT_DELTA(y, 300.0, 1.0);
+    }
+
+    void test_save_load_lookup()
+    {
+        config c;
+        c.elements = 8;
+        c.samples = 4000;
+        c.x_position = 0.0;
+
+        time_of_flight near(c.elements, c.elements, {});
+        time_of_flight far(c.elements, c.elements, {});
+        c.tact_coords_to_tof(20.0, 300.0, near);
+        c.tact_coords_to_tof(60.0, 900.0, far);
+
+        std::stringstream ss;
+        {
+            column_cache cache(c, 1);
+            cache.store(near);
+            cache.store(near);
+            TS_ASSERT_EQUALS(cache.entries().size(), 1);
+            cache.store(far);
+            TS_ASSERT_EQUALS(cache.entries().size(), 2);
+            TS_ASSERT(cache.save(ss));
+        }
+
+        // the capacity keeps one of the columns of the first run.
+        column_cache cache(c, 2);
+        TS_ASSERT(cache.load(ss));
+        TS_ASSERT_EQUALS(cache.entries().size(), 1);
+        std::stringstream ss2;
+        {
+            column_cache first(c, 2);
+            first.store(near);
+            first.store(far);
+            first.save(ss2);
+        }
+
+        // the probe moved by one element : the cached columns are moved under it.
+        config moved = c;
+        moved.x_position = c.pitch;
+        column_cache cache2(moved, 2);
+        TS_ASSERT(cache2.load(ss2));
+        std::vector<time_of_flight> found;
+        TS_ASSERT_EQUALS(
+          cache2.lookup(
+            [](const time_of_flight& tof) { return -1.0 * tof.at(0, 0); },
+            -1000.0,
+            found),
+          1);
+        time_of_flight expected(c.elements, c.elements, {});
+        moved.tact_coords_to_tof(
+          20.0 - moved.element_pitch_in_tacts(), 300.0, expected);
+        TS_ASSERT_DELTA((double)found[0].at(3, 3), (double)expected.at(3, 3), 2.0);
+
+        // the last lookup marked only the near column as used.
+        std::stringstream ss3;
+        cache2.capacity = 1;
+        cache2.save(ss3);
+        column_cache cache3(moved, 0);
+        TS_ASSERT(cache3.load(ss3));
+        TS_ASSERT_EQUALS(cache3.entries().size(), 1);
+        TS_ASSERT_DELTA(cache3.entries()[0].y, 300.0, 1.0);
+
+        // another geometry does not read the cache.
+        config other = c;
+        other.elements = 16;
+        std::stringstream ss4(ss3.str());
+        column_cache cache4(other, 0);
+        TS_ASSERT(!cache4.load(ss4));
+        TS_ASSERT(cache4.entries().empty());
+    }
+};
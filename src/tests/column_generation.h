@@ -2,17 +2,39 @@
 #include "../optlib/grb_column_generation.h"
 #include "../optlib/reader.h"
 #include <cxxtest/TestSuite.h>
+#include <functional>
+#include <memory>
+#include <numeric>
 
 class column_generation_test : public CxxTest::TestSuite
 {
   private:
+    config small_config(unsigned samples,
+                        unsigned elements,
+                        double pitch_in_tacts)
+    {
+        config c;
+        c.x_position = 0.0;
+        c.sampling_rate = 20e6;
+        c.wave_speed = 6350;
+        c.pitch = pitch_in_tacts * c.wave_speed / c.sampling_rate;
+        c.elements = elements;
+        c.wave_length = 6350.0 / 5e6;
+        c.samples = samples;
+        c.reference_samples = 512;
+        return c;
+    }
+
     void helper(double d[],
                 unsigned samples,
                 unsigned elements,
                 std::vector<time_of_flight>& coords,
                 std::vector<double>& results,
                 bool verbose,
-                double pitch_in_tacts = 7.559)
+                double pitch_in_tacts = 7.559,
+                std::function<void(config&)> configure = nullptr,
+                std::function<void(column_generation&)> inspect = nullptr,
+                bool async = false)
     {
         fftw_arr<> measurement(elements, elements, samples);
         std::copy(d, d + samples * elements * elements, measurement.data);
@@ -26,7 +48,10 @@ class column_generation_test : public CxxTest::TestSuite
                coords,
                results,
                verbose,
-               pitch_in_tacts);
+               pitch_in_tacts,
+               configure,
+               inspect,
+               async);
     }
 
     void helper(arr<>& measurement,
@@ -36,20 +61,32 @@ class column_generation_test : public CxxTest::TestSuite
                 std::vector<time_of_flight>& coords,
                 std::vector<double>& results,
                 bool verbose,
-                double pitch_in_tacts = 7.559)
+                double pitch_in_tacts = 7.559,
+                std::function<void(config&)> configure = nullptr,
+                std::function<void(column_generation&)> inspect = nullptr,
+                bool async = false)
     {
-        config c;
-        c.x_position = 0.0;
-        c.sampling_rate = 20e6;
-        c.wave_speed = 6350;
-        c.pitch = pitch_in_tacts * c.wave_speed / c.sampling_rate;
-        c.elements = elements;
-        c.wave_length = 6350.0 / 5e6;
-        c.samples = samples;
-        c.reference_samples = 512;
+        config c = small_config(samples, elements, pitch_in_tacts);
         c.verbose = verbose;
+        if (configure) {
+            configure(c);
+        }
 
-        grb_cg cg(c, measurement, reference_signal);
+        std::unique_ptr<column_generation> cg;
+        if (async) {
+            cg = std::make_unique<grb_cg_multi_slaves>(
+              c,
+              measurement,
+              reference_signal,
+              2,
+              slave_cut_options::OFF,
+              static_cast<slave_callback_options>(
+                slave_callback_options::LAZY_TANGENTS |
+                slave_callback_options::RANDOMISE |
+                slave_callback_options::ROUNDING_DOWN));
+        } else {
+            cg = std::make_unique<grb_cg>(c, measurement, reference_signal);
+        }
 
         //reference_signal.trim(-10, 10);
         std::vector<time_of_flight> _dummy;
@@ -58,7 +95,38 @@ class column_generation_test : public CxxTest::TestSuite
             std::nullopt,
             _dummy,
         };
-        cg.run(w, coords, results);
+        cg->run(w, coords, results);
+        if (inspect) {
+            inspect(*cg);
+        }
+    }
+
+    /// Master objective : l1-norm of the measurement minus the simulation (reference is {1, -1}).
+    double objective(double d[],
+                     unsigned samples,
+                     unsigned elements,
+                     std::vector<time_of_flight>& coords,
+                     std::vector<double>& results)
+    {
+        std::vector<double> residual(d, d + samples * elements * elements);
+        for (unsigned c = 0; c < coords.size(); c++) {
+            for (unsigned i = 0; i < elements; i++) {
+                for (unsigned j = 0; j < elements; j++) {
+                    const unsigned row = (i * elements + j) * samples;
+                    const unsigned tof = coords[c].at(i, j);
+                    if (tof < samples) {
+                        residual[row + tof] -= results[c];
+                    }
+                    if (tof + 1 < samples) {
+                        residual[row + tof + 1] += results[c];
+                    }
+                }
+            }
+        }
+        return std::accumulate(
+          residual.begin(), residual.end(), 0.0, [](double a, double b) {
+              return a + std::abs(b);
+          });
     }
 
   public:
@@ -114,6 +182,256 @@ class column_generation_test : public CxxTest::TestSuite
         }
     }
 
+    void test_stabilised_cg()
+    {
+        const unsigned samples = 5;
+        const unsigned elements = 2;
+        double d[] = { 0, 2, -2, 0,  0, 0, 0, 2,  -2, 0,
+                       0, 0, 2,  -2, 0, 0, 2, -2, 0,  0 };
+        double pitch_in_tacts = 2;
+
+        std::vector<time_of_flight> coords;
+        std::vector<double> results;
+        helper(d, samples, elements, coords, results, false, pitch_in_tacts);
+        const double unstabilised =
+          objective(d, samples, elements, coords, results);
+
+        for (bool async : { false, true }) {
+            for (unsigned mode = dual_stabiliser::WENTGES;
+                 mode <= dual_stabiliser::BOX_STEP;
+                 mode++) {
+                std::vector<time_of_flight> stabilised_coords;
+                std::vector<double> stabilised_results;
+                helper(d,
+                       samples,
+                       elements,
+                       stabilised_coords,
+                       stabilised_results,
+                       false,
+                       pitch_in_tacts,
+                       [&](config& c) { c.stabilisation = mode; },
+                       nullptr,
+                       async);
+                TS_ASSERT_DELTA(objective(d,
+                                          samples,
+                                          elements,
+                                          stabilised_coords,
+                                          stabilised_results),
+                                unstabilised,
+                                1e-6);
+            }
+        }
+    }
+
+    void test_stabilised_cg_iterations()
+    {
+        const unsigned samples = 8;
+        const unsigned elements = 2;
+        // one reflector and some noise.
+        double d[] = { 0, 0, 0, 0, 0, 3,  -3, 0, 0, 0, 0, 0, 3, -3, -1, 0,
+                       0, 0, 0, 0, 3, -3, 1,  0, 0, 0, 0, 2, -3, 0, 0,  0 };
+        double pitch_in_tacts = 2;
+
+        for (bool async : { false, true }) {
+            // geometric_slave and simplex_master are deterministic, Gurobi may pick other degenerate duals.
+            auto run = [&](unsigned mode, double& objective_out) {
+                std::vector<time_of_flight> coords;
+                std::vector<double> results;
+                unsigned iterations = 0;
+                helper(
+                  d,
+                  samples,
+                  elements,
+                  coords,
+                  results,
+                  false,
+                  pitch_in_tacts,
+                  [&](config& c) {
+                      c.stabilisation = mode;
+                      c.geometric_slave = true;
+                      c.in_house_master = true;
+                  },
+                  [&](column_generation& cg) { iterations = cg.iterations; },
+                  async);
+                objective_out = objective(d, samples, elements, coords, results);
+                return iterations;
+            };
+            double unstabilised = 0.0, stabilised = 0.0;
+            const unsigned unstabilised_iterations =
+              run(dual_stabiliser::NONE, unstabilised);
+            const unsigned stabilised_iterations =
+              run(dual_stabiliser::BOX_STEP, stabilised);
+            TS_ASSERT_DELTA(stabilised, unstabilised, 1e-6);
+            TS_ASSERT_LESS_THAN(stabilised_iterations, unstabilised_iterations);
+        }
+    }
+
+    void test_relative_gap_cg()
+    {
+        const unsigned samples = 5;
+        const unsigned elements = 2;
+        double d[] = { 0, 2, -2, 0,  0, 0, 0, 2,  -2, 0,
+                       0, 0, 2,  -2, 0, 0, 2, -2, 0,  0 };
+        double pitch_in_tacts = 2;
+
+        std::vector<time_of_flight> coords;
+        std::vector<double> results;
+        helper(d, samples, elements, coords, results, false, pitch_in_tacts);
+        const double optimal = objective(d, samples, elements, coords, results);
+        const double amplitudes =
+          std::accumulate(results.begin(), results.end(), 0.0);
+
+        // A gap of 0 is only reached when the slaves prove the dual feasible.
+        std::vector<time_of_flight> gap_coords;
+        std::vector<double> gap_results;
+        helper(d,
+               samples,
+               elements,
+               gap_coords,
+               gap_results,
+               false,
+               pitch_in_tacts,
+               [&](config& c) {
+                   c.relative_gap = 0.0;
+                   c.amplitude_bound = amplitudes;
+               });
+        TS_ASSERT_DELTA(
+          objective(d, samples, elements, gap_coords, gap_results),
+          optimal,
+          1e-6);
+    }
+
+    void test_relative_gap_with_amplitude_bound_cg()
+    {
+        const unsigned samples = 5;
+        const unsigned elements = 2;
+        // one reflector and two samples of noise that no reflector explains.
+        double d[] = { 0, 2, -2, 0,  3, 0, 0, 2,  -2, 0,
+                       -1, 0, 2,  -2, 0, 0, 2, -2, 0,  0 };
+        double pitch_in_tacts = 2;
+
+        std::vector<time_of_flight> coords;
+        std::vector<double> results;
+        unsigned iterations = 0;
+        helper(d,
+               samples,
+               elements,
+               coords,
+               results,
+               false,
+               pitch_in_tacts,
+               nullptr,
+               [&](column_generation& cg) { iterations = cg.iterations; });
+        const double optimal = objective(d, samples, elements, coords, results);
+        const double amplitudes =
+          std::accumulate(results.begin(), results.end(), 0.0);
+        TS_ASSERT_LESS_THAN(0.0, optimal);
+
+        std::vector<time_of_flight> gap_coords;
+        std::vector<double> gap_results;
+        double lower_bound = 0.0;
+        unsigned gap_iterations = 0;
+        helper(d,
+               samples,
+               elements,
+               gap_coords,
+               gap_results,
+               false,
+               pitch_in_tacts,
+               [&](config& c) {
+                   c.relative_gap = 0.5;
+                   c.amplitude_bound = amplitudes;
+               },
+               [&](column_generation& cg) {
+                   lower_bound = cg.lower_bound();
+                   gap_iterations = cg.iterations;
+               });
+        const double gap_objective =
+          objective(d, samples, elements, gap_coords, gap_results);
+
+        // the Lagrangian bound moves before the slaves prove optimality and stops the run early.
+        TS_ASSERT_LESS_THAN(0.0, lower_bound);
+        TS_ASSERT_LESS_THAN_EQUALS(lower_bound, optimal + 1e-6);
+        TS_ASSERT_LESS_THAN_EQUALS(relative_gap(gap_objective, lower_bound),
+                                   0.5);
+        TS_ASSERT_LESS_THAN(gap_iterations, iterations);
+    }
+
+    void test_relative_gap_needs_amplitude_bound()
+    {
+        config c;
+        c.relative_gap = 0.1;
+        TS_ASSERT_THROWS_ANYTHING(c.consistency_check());
+        c.amplitude_bound = 10.0;
+        TS_ASSERT_THROWS_NOTHING(c.consistency_check());
+    }
+
+    void test_dual_saft_cg()
+    {
+        const unsigned samples = 5;
+        const unsigned elements = 2;
+        double d[] = { 0, 2, -2, 0,  0, 0, 0, 2,  -2, 0,
+                       0, 0, 2,  -2, 0, 0, 2, -2, 0,  0 };
+        double pitch_in_tacts = 2;
+
+        std::vector<time_of_flight> coords;
+        std::vector<double> results;
+        helper(d, samples, elements, coords, results, false, pitch_in_tacts);
+        const double optimal = objective(d, samples, elements, coords, results);
+
+        // the slaves prove optimality when the heuristic finds nothing.
+        std::vector<time_of_flight> saft_coords;
+        std::vector<double> saft_results;
+        unsigned heuristic_iterations = 0;
+        helper(
+          d,
+          samples,
+          elements,
+          saft_coords,
+          saft_results,
+          false,
+          pitch_in_tacts,
+          [](config& c) { c.dual_saft_resolution = 16; },
+          [&](column_generation& cg) {
+              heuristic_iterations = cg.heuristic_iterations;
+          });
+        TS_ASSERT_LESS_THAN(0u, heuristic_iterations);
+        TS_ASSERT_DELTA(
+          objective(d, samples, elements, saft_coords, saft_results),
+          optimal,
+          1e-6);
+    }
+
+    void test_dual_saft_columns_separate()
+    {
+        const unsigned samples = 5;
+        const unsigned elements = 2;
+        double d[] = { 0, 2, -2, 0,  0, 0, 0, 2,  -2, 0,
+                       0, 0, 2,  -2, 0, 0, 2, -2, 0,  0 };
+        fftw_arr<> measurement(elements, elements, samples);
+        std::copy(d, d + samples * elements * elements, measurement.data);
+        arr_1d<fftw_arr> reference_signal(2);
+        reference_signal(0, 0, 0) = 1;
+        reference_signal(0, 0, 1) = -1;
+
+        config c = small_config(samples, elements, 2);
+        c.dual_saft_resolution = 16;
+        column_generation_run<fftw_arr> run(measurement, reference_signal, c);
+        simplex_master master(false, std::cout, master_problem::SIMPLEX, 0.0);
+        std::vector<time_of_flight> no_warm_start;
+        run.initial_master_run(master, no_warm_start, std::nullopt, false);
+
+        fourier_convolution conv;
+        TS_ASSERT(run.heuristic_run(conv));
+        TS_ASSERT(!run.columns_for_masters_update().empty());
+        for (const column& current : run.columns_for_masters_update()) {
+            TS_ASSERT_LESS_THAN(
+              c.slave_threshold,
+              current.tof.dot_product_with_dual(
+                reference_signal, run.pricing_dual(), c.get_roi_start()));
+        }
+    }
+
     void test_double_cg()
     {
         std::vector<time_of_flight> coords;
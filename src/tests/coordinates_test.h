@@ -177,6 +177,64 @@ class coord_test : public CxxTest::TestSuite
         }
     }
 
+    void test_batch_feasibility()
+    {
+        const double pitch = 3.78;
+        const std::vector<unsigned> origin = {
+            303, 301, 300, 300, 299, 299, 298, 297, 297, 297, 297,
+        };
+        const unsigned elements = origin.size();
+
+        // Perturb every element of a feasible diagonal so that both feasible and infeasible candidates are checked.
+        std::vector<std::vector<unsigned>> candidates;
+        // candidates whose intervals degenerate: the scalar version throws.
+        std::vector<bool> degenerated;
+        for (unsigned e = 0; e < elements; e++) {
+            for (int offset = -12; offset <= 12; offset += 3) {
+                std::vector<unsigned> current = origin;
+                current[e] += offset;
+                candidates.push_back(current);
+                try {
+                    coordinate_tools::tof_feasible_in_range(
+                      current.begin(), current.end(), elements, pitch);
+                    degenerated.push_back(false);
+                } catch (exception&) {
+                    degenerated.push_back(true);
+                }
+            }
+        }
+
+        tof_feasibility_batch batch(elements, 16, pitch);
+        unsigned checked = 0;
+        while (checked < candidates.size()) {
+            batch.clear();
+            const unsigned start = checked;
+            while (!batch.full() && checked < candidates.size()) {
+                batch.add(candidates[checked].begin(),
+                          candidates[checked].end());
+                checked++;
+            }
+            batch.check();
+            for (unsigned c = 0; c < batch.candidates; c++) {
+                auto& current = candidates[start + c];
+                TS_ASSERT_EQUALS(batch.empty_interval(c),
+                                 degenerated[start + c]);
+                if (degenerated[start + c]) {
+                    TS_ASSERT(!batch.feasible(c));
+                    continue;
+                }
+                TSM_ASSERT_EQUALS(std::to_string(start + c),
+                                  batch.feasible(c),
+                                  coordinate_tools::tof_feasible_in_range(
+                                    current.begin(),
+                                    current.end(),
+                                    elements,
+                                    pitch));
+            }
+        }
+        TS_ASSERT(candidates.size() > batch.capacity);
+    }
+
     void test_strange_tof()
     {
         //TODO: add strange tof here
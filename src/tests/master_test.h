@@ -1,9 +1,13 @@
 #include <cxxtest/TestSuite.h>
 #include <numeric>
 
+#include "../optlib/adaptive_solver.h"
 #include "../optlib/coordinates.h"
+#include "../optlib/fftw_convolution.h"
 #include "../optlib/grb_master.h"
+#include "../optlib/pdhg_master.h"
 #include "../optlib/reader.h"
+#include "../optlib/simplex_master.h"
 #include "gurobi_c++.h"
 #include <optional>
 
@@ -98,6 +102,458 @@ class master_test : public CxxTest::TestSuite
                               after_add_dual.values.begin()));
     }
 
+    void test_simplex_master_same_as_grb_master()
+    {
+        GRBEnv e;
+        grb_master grb(&e, false, std::cout, master_problem::SIMPLEX, 0.0);
+        simplex_master simplex(false, std::cout, master_problem::SIMPLEX, 0.0);
+
+        const unsigned elements = 2;
+        const unsigned measurement_length = 12;
+        const unsigned ref_length = 3;
+        const unsigned offset = 2;
+        arr<> measurement(elements, elements, measurement_length);
+        arr_1d<arr, double> reference_signal(ref_length);
+        reference_signal.for_ijk(
+          [&](unsigned i, unsigned j, unsigned k) { return k + 1.0; });
+        measurement.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+            return std::sin(i + 3.0 * j + 0.7 * k) * 5.0;
+        });
+
+        arr<> _dual(elements, elements, measurement_length);
+        dual_solution dual{ _dual, { 0, 0, 0 } };
+        double grb_obj, simplex_obj;
+
+        auto check = [&]() {
+            grb.solve_reduced_problem(
+              elements, offset, measurement, reference_signal, {}, dual, grb_obj);
+            simplex.solve_reduced_problem(elements,
+                                          offset,
+                                          measurement,
+                                          reference_signal,
+                                          {},
+                                          dual,
+                                          simplex_obj);
+            TS_ASSERT_DELTA(grb_obj, simplex_obj, 1e-6);
+
+            // strong duality and dual feasibility of the in-house duals.
+            double dual_obj = 0.0;
+            for (unsigned r = 0; r < measurement.size(); r++) {
+                TS_ASSERT_LESS_THAN_EQUALS(std::abs(dual.values.data[r]),
+                                           1.0 + 1e-9);
+                dual_obj += dual.values.data[r] * measurement.data[r];
+            }
+            TS_ASSERT_DELTA(dual_obj, simplex_obj, 1e-6);
+        };
+
+        check();
+        for (unsigned shift = 0; shift < measurement_length; shift += 2) {
+            for (unsigned variant = 0; variant < 2; variant++) {
+                time_of_flight add_me(elements, elements, {});
+                add_me.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+                    return offset + shift + variant * (j + k);
+                });
+                time_of_flight copy(elements, elements, {});
+                std::copy(add_me.begin(), add_me.end(), copy.begin());
+                grb.add_variable(add_me, reference_signal, std::nullopt);
+                simplex.add_variable(copy, reference_signal, std::nullopt);
+            }
+            check();
+            TS_ASSERT_EQUALS(grb.clean(), simplex.clean());
+        }
+    }
+
+    void test_simplex_master_many_updates()
+    {
+        GRBEnv e;
+        grb_master grb(&e, false, std::cout, master_problem::SIMPLEX, 0.0);
+        simplex_master simplex(false, std::cout, master_problem::SIMPLEX, 0.0);
+
+        const unsigned elements = 3;
+        const unsigned measurement_length = 40;
+        const unsigned offset = 2;
+        arr<> measurement(elements, elements, measurement_length);
+        arr_1d<arr, double> reference_signal(5);
+        reference_signal.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+            return std::sin(1.3 * k) + 0.2;
+        });
+        measurement.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+            return std::sin(i + 3.0 * j + 0.7 * k) * 5.0 + std::cos(2.3 * k);
+        });
+
+        arr<> _dual(elements, elements, measurement_length);
+        dual_solution dual{ _dual, { 0, 0, 0 } };
+        double grb_obj, simplex_obj;
+        grb.solve_reduced_problem(
+          elements, offset, measurement, reference_signal, {}, dual, grb_obj);
+        simplex.solve_reduced_problem(
+          elements, offset, measurement, reference_signal, {}, dual, simplex_obj);
+        unsigned iterations = 0;
+        for (unsigned round = 0; round < 4; round++) {
+            // enough pivots to refactorise the basis several times
+            for (unsigned v = 0; v < 40; v++) {
+                time_of_flight add_me(elements, elements, {});
+                add_me.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+                    return offset + (7 * v + 3 * round) % measurement_length +
+                           (v * (i + 2 * j)) % 3;
+                });
+                time_of_flight copy(elements, elements, {});
+                std::copy(add_me.begin(), add_me.end(), copy.begin());
+                grb.add_variable(add_me, reference_signal, std::nullopt);
+                simplex.add_variable(copy, reference_signal, std::nullopt);
+            }
+            grb.solve_reduced_problem(
+              elements, offset, measurement, reference_signal, {}, dual, grb_obj);
+            simplex.solve_reduced_problem(elements,
+                                          offset,
+                                          measurement,
+                                          reference_signal,
+                                          {},
+                                          dual,
+                                          simplex_obj);
+            iterations += simplex.iterations;
+            TS_ASSERT_DELTA(grb_obj, simplex_obj, 1e-6 * grb_obj);
+            TS_ASSERT_EQUALS(grb.clean(), simplex.clean());
+        }
+        TS_ASSERT_LESS_THAN(64u, iterations);
+    }
+
+    void test_simplex_master_repairs_singular_basis()
+    {
+        simplex_master simplex(false, std::cout, master_problem::SIMPLEX, 0.0);
+
+        const unsigned elements = 2;
+        const unsigned measurement_length = 20;
+        const unsigned offset = 2;
+        arr<> measurement(elements, elements, measurement_length);
+        arr_1d<arr, double> reference_signal(3);
+        reference_signal.for_ijk(
+          [&](unsigned i, unsigned j, unsigned k) { return k + 1.0; });
+        measurement.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+            return std::sin(i + 3.0 * j + 0.7 * k) * 5.0;
+        });
+
+        arr<> _dual(elements, elements, measurement_length);
+        dual_solution dual{ _dual, { 0, 0, 0 } };
+        double obj, repaired_obj;
+        simplex.solve_reduced_problem(
+          elements, offset, measurement, reference_signal, {}, dual, obj);
+        for (unsigned shift = 0; shift < 10; shift += 3) {
+            time_of_flight add_me(elements, elements, {});
+            add_me.for_ijk(
+              [&](unsigned i, unsigned j, unsigned k) { return offset + shift; });
+            simplex.add_variable(add_me, reference_signal, std::nullopt);
+        }
+        simplex.solve_reduced_problem(
+          elements, offset, measurement, reference_signal, {}, dual, obj);
+        TS_ASSERT(!simplex.basic_variables.empty());
+
+        // a copy of a basic variable together with another tight row makes the basis singular
+        time_of_flight copy(elements, elements, {});
+        const time_of_flight& basic = *std::next(
+          simplex.name2tof.begin(), simplex.basic_variables.front());
+        std::copy(basic.begin(), basic.end(), copy.begin());
+        simplex.add_variable(copy, reference_signal, std::nullopt);
+        simplex.basic_variables.push_back(simplex.variables.size() - 1);
+        for (unsigned row = 0; row < simplex.row_slot.size(); row++) {
+            if (simplex.row_slot[row] == simplex_master::no_slot) {
+                simplex.row_slot[row] = simplex.tight_rows.size();
+                simplex.tight_rows.push_back(row);
+                break;
+            }
+        }
+
+        TS_ASSERT_THROWS_NOTHING(
+          simplex.solve_reduced_problem(elements,
+                                        offset,
+                                        measurement,
+                                        reference_signal,
+                                        {},
+                                        dual,
+                                        repaired_obj));
+        TS_ASSERT_DELTA(obj, repaired_obj, 1e-6);
+    }
+
+    void test_simplex_master_warm_start()
+    {
+        simplex_master cold(false, std::cout, master_problem::SIMPLEX, 0.0);
+        simplex_master warm(false, std::cout, master_problem::SIMPLEX, 0.0);
+
+        const unsigned elements = 2;
+        const unsigned measurement_length = 12;
+        const unsigned offset = 2;
+        arr<> measurement(elements, elements, measurement_length);
+        arr_1d<arr, double> reference_signal(3);
+        reference_signal.for_ijk(
+          [&](unsigned i, unsigned j, unsigned k) { return k + 1.0; });
+        measurement.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+            return std::sin(i + 3.0 * j + 0.7 * k) * 5.0;
+        });
+
+        arr<> _dual(elements, elements, measurement_length);
+        dual_solution dual{ _dual, { 0, 0, 0 } };
+        double cold_obj, warm_obj;
+        for (simplex_master* m : { &cold, &warm }) {
+            m->solve_reduced_problem(
+              elements, offset, measurement, reference_signal, {}, dual, cold_obj);
+            for (unsigned shift = 0; shift < measurement_length; shift += 2) {
+                time_of_flight add_me(elements, elements, {});
+                add_me.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+                    return offset + shift + j + k;
+                });
+                m->add_variable(add_me, reference_signal, std::nullopt);
+            }
+        }
+        cold.solve_reduced_problem(
+          elements, offset, measurement, reference_signal, {}, dual, cold_obj);
+        TS_ASSERT_LESS_THAN(0u, cold.iterations);
+
+        // starting from the optimum needs no pivots.
+        std::vector<double> optimum;
+        cold.get_primal(optimum);
+        warm.set_warm_start(optimum, dual.values);
+        warm.solve_reduced_problem(
+          elements, offset, measurement, reference_signal, {}, dual, warm_obj);
+        TS_ASSERT_DELTA(cold_obj, warm_obj, 1e-6);
+        TS_ASSERT_EQUALS(warm.iterations, 0u);
+    }
+
+    void test_pdhg_master_same_as_simplex_master()
+    {
+        simplex_master simplex(false, std::cout, master_problem::SIMPLEX, 0.0);
+        pdhg_master<fftw_arr> pdhg(false,
+                                   std::cout,
+                                   master_problem::SIMPLEX,
+                                   0.0,
+                                   new fourier_convolution(),
+                                   new fourier_convolution(),
+                                   nullptr);
+        pdhg.tolerance = 1e-6;
+        pdhg.max_iterations = 100000;
+        pdhg_master<fftw_arr> polished(
+          false,
+          std::cout,
+          master_problem::SIMPLEX,
+          0.0,
+          new fourier_convolution(),
+          new fourier_convolution(),
+          new simplex_master(false, std::cout, master_problem::SIMPLEX, 0.0));
+
+        const unsigned elements = 2;
+        const unsigned measurement_length = 12;
+        const unsigned ref_length = 3;
+        const unsigned offset = 2;
+        arr<> measurement(elements, elements, measurement_length);
+        arr_1d<arr, double> reference_signal(ref_length);
+        reference_signal.for_ijk(
+          [&](unsigned i, unsigned j, unsigned k) { return k + 1.0; });
+        measurement.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+            return std::sin(i + 3.0 * j + 0.7 * k) * 5.0;
+        });
+
+        arr<> _dual(elements, elements, measurement_length);
+        dual_solution dual{ _dual, { 0, 0, 0 } };
+        double simplex_obj, pdhg_obj, polished_obj;
+
+        auto check = [&]() {
+            simplex.solve_reduced_problem(elements,
+                                          offset,
+                                          measurement,
+                                          reference_signal,
+                                          {},
+                                          dual,
+                                          simplex_obj);
+            pdhg.solve_reduced_problem(
+              elements, offset, measurement, reference_signal, {}, dual, pdhg_obj);
+            TS_ASSERT_DELTA(pdhg_obj, simplex_obj, 1e-4 * simplex_obj);
+            for (unsigned r = 0; r < measurement.size(); r++) {
+                TS_ASSERT_LESS_THAN_EQUALS(std::abs(dual.values.data[r]), 1.0);
+            }
+
+            polished.solve_reduced_problem(elements,
+                                           offset,
+                                           measurement,
+                                           reference_signal,
+                                           {},
+                                           dual,
+                                           polished_obj);
+            TS_ASSERT_DELTA(polished_obj, simplex_obj, 1e-6);
+        };
+
+        check();
+        for (unsigned shift = 0; shift < measurement_length; shift += 2) {
+            for (unsigned variant = 0; variant < 2; variant++) {
+                for (master_problem* m :
+                     std::vector<master_problem*>{ &simplex, &pdhg, &polished }) {
+                    time_of_flight add_me(elements, elements, {});
+                    add_me.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+                        return offset + shift + variant * (j + k);
+                    });
+                    m->add_variable(add_me, reference_signal, std::nullopt);
+                }
+            }
+            check();
+            TS_ASSERT_EQUALS(simplex.clean(), polished.clean());
+            pdhg.clean();
+        }
+    }
+
+    void test_add_variables_same_as_add_variable()
+    {
+        GRBEnv e;
+        grb_master single(&e, false, std::cout, master_problem::SIMPLEX, 0.0);
+        grb_master batch(&e, false, std::cout, master_problem::SIMPLEX, 0.0);
+
+        const unsigned elements = 2;
+        const unsigned measurement_length = 12;
+        const unsigned offset = 2;
+        arr<> measurement(elements, elements, measurement_length);
+        arr_1d<arr, double> reference_signal(3);
+        reference_signal.for_ijk(
+          [&](unsigned i, unsigned j, unsigned k) { return k + 1.0; });
+        measurement.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+            return std::sin(i + 3.0 * j + 0.7 * k) * 5.0;
+        });
+
+        arr<> _dual(elements, elements, measurement_length);
+        dual_solution dual{ _dual, { 0, 0, 0 } };
+        double single_obj, batch_obj;
+        single.solve_reduced_problem(
+          elements, offset, measurement, reference_signal, {}, dual, single_obj);
+        batch.solve_reduced_problem(
+          elements, offset, measurement, reference_signal, {}, dual, batch_obj);
+
+        std::vector<time_of_flight> variables;
+        std::vector<double> warm_start_values;
+        for (unsigned shift = 0; shift < measurement_length; shift++) {
+            time_of_flight add_me(elements, elements, {});
+            add_me.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+                return offset + shift + (shift % 2) * (j + k);
+            });
+            time_of_flight copy(elements, elements, {});
+            std::copy(add_me.begin(), add_me.end(), copy.begin());
+            single.add_variable(copy, reference_signal, 1.0);
+            variables.push_back(std::move(add_me));
+            warm_start_values.push_back(1.0);
+        }
+        batch.add_variables(variables, reference_signal, warm_start_values);
+        TS_ASSERT_EQUALS(single.name2tof.size(), batch.name2tof.size());
+        TS_ASSERT(std::equal(single.name2tof.begin(),
+                             single.name2tof.end(),
+                             batch.name2tof.begin(),
+                             [](const time_of_flight& a,
+                                const time_of_flight& b) {
+                                 return std::equal(
+                                   a.begin(), a.end(), b.begin(), b.end());
+                             }));
+
+        single.solve_reduced_problem(
+          elements, offset, measurement, reference_signal, {}, dual, single_obj);
+        batch.solve_reduced_problem(
+          elements, offset, measurement, reference_signal, {}, dual, batch_obj);
+        TS_ASSERT_DELTA(single_obj, batch_obj, 1e-9);
+    }
+
+    void test_lazy_rows_same_as_all_rows()
+    {
+        GRBEnv e;
+        grb_master full(&e, false, std::cout, master_problem::SIMPLEX, 0.0);
+        grb_master lazy(&e, false, std::cout, master_problem::SIMPLEX, 0.0);
+        lazy.lazy_rows = 1e-9;
+
+        const unsigned elements = 2;
+        const unsigned measurement_length = 20;
+        const unsigned offset = 2;
+        arr<> measurement(elements, elements, measurement_length);
+        arr_1d<arr, double> reference_signal(3);
+        reference_signal.for_ijk(
+          [&](unsigned i, unsigned j, unsigned k) { return k + 1.0; });
+        // one short echo per sender-receiver-pair, silent everywhere else.
+        measurement.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+            const unsigned echo = 6 + i + j;
+            return k >= echo && k < echo + 3 ? std::sin(i + 3.0 * j + k) * 5.0
+                                             : 0.0;
+        });
+
+        arr<> _dual(elements, elements, measurement_length);
+        dual_solution dual{ _dual, { 0, 0, 0 } };
+        double full_obj, lazy_obj;
+
+        auto check = [&]() {
+            full.solve_reduced_problem(
+              elements, offset, measurement, reference_signal, {}, dual, full_obj);
+            lazy.solve_reduced_problem(
+              elements, offset, measurement, reference_signal, {}, dual, lazy_obj);
+            TS_ASSERT_DELTA(full_obj, lazy_obj, 1e-6);
+
+            // the zero duals of the missing rows keep strong duality.
+            double dual_obj = 0.0;
+            for (unsigned r = 0; r < measurement.size(); r++) {
+                dual_obj += dual.values.data[r] * measurement.data[r];
+            }
+            TS_ASSERT_DELTA(dual_obj, lazy_obj, 1e-6);
+        };
+
+        check();
+        TS_ASSERT_LESS_THAN(lazy.active_rows.size(), measurement.size());
+        for (unsigned shift = 0; shift + offset < measurement_length;
+             shift += 3) {
+            time_of_flight add_me(elements, elements, {});
+            add_me.for_ijk([&](unsigned i, unsigned j, unsigned k) {
+                return offset + shift + j + k;
+            });
+            time_of_flight copy(elements, elements, {});
+            std::copy(add_me.begin(), add_me.end(), copy.begin());
+            full.add_variable(add_me, reference_signal, std::nullopt);
+            lazy.add_variable(copy, reference_signal, std::nullopt);
+            check();
+        }
+        full.clean();
+        lazy.clean();
+        check();
+    }
+
+    void test_adaptive_solver()
+    {
+        adaptive_solver adaptive(
+          { master_problem::SIMPLEX, master_problem::DUAL_SIMPLEX }, 3);
+
+        // every method is measured once per context.
+        TS_ASSERT_EQUALS(adaptive.next(adaptive_solver::AFTER_ADD),
+                         master_problem::SIMPLEX);
+        adaptive.record(adaptive_solver::AFTER_ADD, master_problem::SIMPLEX, 2.0);
+        TS_ASSERT_EQUALS(adaptive.next(adaptive_solver::AFTER_ADD),
+                         master_problem::DUAL_SIMPLEX);
+        adaptive.record(
+          adaptive_solver::AFTER_ADD, master_problem::DUAL_SIMPLEX, 1.0);
+        TS_ASSERT_EQUALS(adaptive.next(adaptive_solver::AFTER_CLEAN),
+                         master_problem::SIMPLEX);
+        adaptive.record(
+          adaptive_solver::AFTER_CLEAN, master_problem::SIMPLEX, 1.0);
+        adaptive.record(
+          adaptive_solver::AFTER_CLEAN, master_problem::DUAL_SIMPLEX, 4.0);
+
+        // afterwards the fastest method is used, with an exploration every 3rd solve.
+        std::vector<master_problem::solver> chosen;
+        for (unsigned i = 0; i < 4; i++) {
+            chosen.push_back(adaptive.next(adaptive_solver::AFTER_ADD));
+        }
+        TS_ASSERT_EQUALS(std::count(chosen.begin(),
+                                    chosen.end(),
+                                    master_problem::DUAL_SIMPLEX),
+                         3);
+        TS_ASSERT_EQUALS(
+          std::count(chosen.begin(), chosen.end(), master_problem::SIMPLEX), 1);
+        TS_ASSERT_EQUALS(adaptive.fastest(adaptive_solver::AFTER_CLEAN),
+                         master_problem::SIMPLEX);
+
+        // smoothed runtimes follow the measurements.
+        adaptive.record(
+          adaptive_solver::AFTER_ADD, master_problem::DUAL_SIMPLEX, 5.0);
+        TS_ASSERT_EQUALS(adaptive.fastest(adaptive_solver::AFTER_ADD),
+                         master_problem::SIMPLEX);
+    }
+
     void test_simple_master_with_offset()
     {
         GRBEnv e;
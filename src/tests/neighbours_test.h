@@ -1,6 +1,8 @@
 
+#include "../optlib/local_search_slave.h"
 #include "../optlib/neighbours.h"
 #include "../optlib/visualizer.h"
+#include <algorithm>
 #include <cxxtest/TestSuite.h>
 #include <numeric>
 
@@ -15,6 +17,96 @@ class neighbours_test : public CxxTest::TestSuite
         std::cout << "}" << std::endl;
     }
 
+  public:
+    void test_local_search_moves_to_better_neighbour()
+    {
+        const unsigned elements = 2;
+        const unsigned samples = 60;
+        const unsigned offset = 10;
+        // every sender-receiver-pair prefers a tof of 31, the centre lies at 30.
+        arr<> f(elements, elements, samples);
+        f.for_ijk([&](unsigned, unsigned, unsigned k) {
+            return k + offset == 31 ? 1.0 : 0.0;
+        });
+
+        std::list<time_of_flight> variables;
+        for (unsigned amplitude = 0; amplitude < 2; amplitude++) {
+            variables.emplace_back(elements, elements, std::nullopt);
+            std::fill(variables.back().begin(), variables.back().end(), 30);
+        }
+        local_search_slave s(3, 1, 5, offset, 0.5, [](column&&) {});
+        // the second variable is not used by the master.
+        s.set_centres(variables, { 1.0, 0.0 });
+        TS_ASSERT_EQUALS(s.centres_size(), 1u);
+
+        columns results;
+        s.run(f, results);
+        TS_ASSERT_EQUALS(results.size(), 1u);
+        if (!results.empty()) {
+            TS_ASSERT_EQUALS(results[0].stats.objective, 4.0);
+            for (unsigned i = 0; i < elements; i++) {
+                for (unsigned j = 0; j < elements; j++) {
+                    TS_ASSERT_EQUALS(results[0].tof.at(i, j), 31u);
+                }
+            }
+        }
+    }
+
+    void test_for_each_neighbour_like_tree()
+    {
+        //diagonal taken from one cgdump
+        const std::vector<unsigned> data = {
+            241, 239, 238, 236, 236, 235, 234, 234,
+            234, 234, 235, 235, 236, 238, 239, 241,
+        };
+
+        // (elements, radius) pairs that have neighbours.
+        const std::vector<std::pair<unsigned, unsigned>> cases = {
+            { 4, 1 }, { 4, 2 }, { 8, 1 }, { 8, 2 }, { 16, 2 }
+        };
+        for (const auto& test_case : cases) {
+            const unsigned elements = test_case.first;
+            const unsigned radius = test_case.second;
+            time_of_flight tof(elements, elements, std::nullopt);
+            std::copy(
+              data.begin(), data.begin() + elements, tof.diagonal_begin());
+            neighbours n{ 7.559 / 2 };
+
+            std::vector<std::vector<unsigned>> from_tree;
+            n.all_in_circle(tof, radius, [&](tree<unsigned>& node) {
+                if (node.depth < elements) {
+                    return;
+                }
+                std::list<unsigned> diagonal;
+                node.data_until_leaf(diagonal);
+                from_tree.emplace_back(diagonal.begin(), diagonal.end());
+            });
+
+            std::vector<std::vector<unsigned>> enumerated;
+            n.for_each_neighbour(
+              tof, radius, [&](const std::vector<unsigned>& diagonal) {
+                  enumerated.push_back(diagonal);
+                  return true;
+              });
+
+            TS_ASSERT(!enumerated.empty());
+            TS_ASSERT(enumerated == from_tree);
+
+            // stopping after the first neighbours gives a prefix of the enumeration.
+            const unsigned stop = std::min<unsigned>(3, enumerated.size());
+            std::vector<std::vector<unsigned>> prefix;
+            n.for_each_neighbour(
+              tof, radius, [&](const std::vector<unsigned>& diagonal) {
+                  prefix.push_back(diagonal);
+                  return prefix.size() < stop;
+              });
+            TS_ASSERT_EQUALS(prefix.size(), stop);
+            TS_ASSERT(std::equal(
+              prefix.begin(), prefix.end(), enumerated.begin()));
+        }
+    }
+
+  private:
     //TODO: fix neighbours if they are needed someday, make sure not to swap pitch and double_pitch!
 //  public:
 //    void test_tof_feasibility()
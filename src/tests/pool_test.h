@@ -1,6 +1,11 @@
+#include "../optlib/column_pool.h"
 #include "../optlib/constraint_pool.h"
+#include "../optlib/slave_portfolio.h"
+#include "../optlib/strip_decomposition.h"
+#include <chrono>
 #include <cxxtest/TestSuite.h>
 #include <list>
+#include <thread>
 #include <numeric>
 
 class pool_test : public CxxTest::TestSuite
@@ -35,4 +40,213 @@ class pool_test : public CxxTest::TestSuite
         TS_ASSERT_EQUALS(l.size(), before);
         TS_ASSERT_EQUALS(counter, old_counter + 3);
     }
+
+    void test_column_pool()
+    {
+        column_pool pool(3, 1);
+        std::vector<time_of_flight> cleaned;
+        for (unsigned value = 0; value < 4; value++) {
+            cleaned.emplace_back(1, 1, std::nullopt);
+            cleaned.back().at(0, 0) = value;
+        }
+        pool.add(cleaned);
+        TS_ASSERT(cleaned.empty());
+        // the oldest column was dropped.
+        TS_ASSERT_EQUALS(pool.size(), 3u);
+
+        auto reduced_cost = [](const time_of_flight& tof) {
+            return (double)tof.at(0, 0);
+        };
+        columns out;
+        TS_ASSERT_EQUALS(pool.reprice(reduced_cost, 2.5, out), 1u);
+        TS_ASSERT_EQUALS(out.size(), 1u);
+        TS_ASSERT_EQUALS(out.front().tof.at(0, 0), 3u);
+        TS_ASSERT_EQUALS(out.front().stats.objective, 3.0);
+        TS_ASSERT_EQUALS(pool.size(), 2u);
+
+        // too old after the second reprice.
+        TS_ASSERT_EQUALS(pool.reprice(reduced_cost, 2.5, out), 0u);
+        TS_ASSERT(pool.empty());
+
+        column_pool disabled(0, 1);
+        cleaned.emplace_back(1, 1, std::nullopt);
+        disabled.add(cleaned);
+        TS_ASSERT(disabled.empty());
+    }
+
+    void test_constraint_pool_priority_and_duplicates()
+    {
+        constraint_pool pool;
+        auto add = [&](unsigned value, unsigned slave_id) {
+            time_of_flight tof(1, 1, std::nullopt);
+            tof.at(0, 0) = value;
+            pool.add({ std::move(tof), { 0, 0, 0, 0, 0, 0 } }, slave_id);
+        };
+        add(1, 1);
+        add(2, 1);
+        add(3, 2);
+        add(2, 2);
+
+        auto reduced_cost = [](column_with_origin& c) {
+            return (double)c.c.tof.at(0, 0);
+        };
+        columns out;
+        TS_ASSERT(pool.consume_non_blocking(out, reduced_cost, 1.5));
+        // best first, the second 2 was merged.
+        TS_ASSERT_EQUALS(out.size(), 2u);
+        TS_ASSERT_EQUALS(out[0].tof.at(0, 0), 3u);
+        TS_ASSERT_EQUALS(out[1].tof.at(0, 0), 2u);
+        TS_ASSERT_EQUALS(pool.duplicate_count(), 1u);
+
+        // the slaves never block : the master waits until one of them delivers.
+        const unsigned producers = 4, per_producer = 500;
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < producers; t++) {
+            threads.emplace_back([&, t]() {
+                for (unsigned i = 0; i < per_producer; i++) {
+                    add(10 + t * per_producer + i, 3);
+                }
+            });
+        }
+        out.clear();
+        while (out.size() < producers * per_producer) {
+            pool.consume(out, reduced_cost, 1.5);
+        }
+        for (std::thread& t : threads) {
+            t.join();
+        }
+        TS_ASSERT_EQUALS(out.size(), producers * per_producer);
+        TS_ASSERT(!pool.consume_non_blocking(out, reduced_cost, 1.5));
+        TS_ASSERT(pool.consume_non_blocking(out, reduced_cost, 0.5));
+        TS_ASSERT_EQUALS(out.back().tof.at(0, 0), 1u);
+    }
+
+    void test_constraint_pool_eviction()
+    {
+        constraint_pool pool;
+        pool.capacity = 2;
+        auto add = [&](unsigned value, unsigned slave_id) {
+            time_of_flight tof(1, 1, std::nullopt);
+            tof.at(0, 0) = value;
+            pool.add({ std::move(tof), { 0, 0, 0, 0, 0, 0 } }, slave_id);
+        };
+        add(1, 2);
+        add(2, 1);
+        add(3, 1);
+        add(4, 2);
+
+        auto reduced_cost = [](column_with_origin& c) {
+            return (double)c.c.tof.at(0, 0);
+        };
+        columns out;
+        // nothing beats 10 : the worst column of the oldest slave (2) goes first, then (3).
+        TS_ASSERT(!pool.consume_non_blocking(out, reduced_cost, 10.0));
+        unsigned evictions, hits;
+        pool.get_eviction_statistics(evictions, hits);
+        TS_ASSERT_EQUALS(evictions, 2u);
+        TS_ASSERT_EQUALS(hits, 0u);
+
+        TS_ASSERT(pool.consume_non_blocking(out, reduced_cost, 0.0));
+        TS_ASSERT_EQUALS(out.size(), 2u);
+        TS_ASSERT_EQUALS(out[0].tof.at(0, 0), 4u);
+        TS_ASSERT_EQUALS(out[1].tof.at(0, 0), 1u);
+        pool.get_eviction_statistics(evictions, hits);
+        TS_ASSERT_EQUALS(hits, 2u);
+        TS_ASSERT_EQUALS(out[1].stats.pool_hits, 2u);
+        TS_ASSERT_EQUALS(out[1].stats.pool_evictions, 2u);
+    }
+
+    void test_constraint_pool_batch()
+    {
+        using namespace std::chrono_literals;
+        constraint_pool pool;
+        auto add = [&](unsigned value) {
+            time_of_flight tof(1, 1, std::nullopt);
+            tof.at(0, 0) = value;
+            pool.add({ std::move(tof), { 0, 0, 0, 0, 0, 0 } }, 1);
+        };
+        auto reduced_cost = [](column_with_origin& c) {
+            return (double)c.c.tof.at(0, 0);
+        };
+
+        // a late slave completes the batch before the wait ends.
+        add(1);
+        std::thread slave([&]() {
+            std::this_thread::sleep_for(20ms);
+            add(2);
+            add(3);
+        });
+        columns out;
+        pool.consume_batch(out, reduced_cost, 0.0, 3, 10s);
+        slave.join();
+        TS_ASSERT_EQUALS(out.size(), 3u);
+
+        // an incomplete batch is returned after the wait, columns in out count.
+        add(4);
+        columns partial;
+        TS_ASSERT(pool.consume_non_blocking(partial, reduced_cost, 0.0));
+        add(5);
+        pool.consume_batch(partial, reduced_cost, 0.0, 3, 10ms);
+        TS_ASSERT_EQUALS(partial.size(), 2u);
+    }
+
+    void test_slave_portfolio()
+    {
+        slave_portfolio portfolio(
+          slave_portfolio::default_configurations(slave_cut_options::OFF, 0),
+          1,
+          0.25);
+        TS_ASSERT_EQUALS(portfolio.configurations.size(), 3u);
+
+        // every configuration is tried once first.
+        for (unsigned c = 0; c < 3; c++) {
+            TS_ASSERT_EQUALS(portfolio.start(), c);
+        }
+        portfolio.finish(0, 10, 1.0);
+        portfolio.finish(1, 1, 1.0);
+        portfolio.finish(2, 4, 1.0);
+        TS_ASSERT(!portfolio.killed(0));
+        TS_ASSERT(portfolio.killed(1));
+        TS_ASSERT(!portfolio.killed(2));
+
+        // the fastest configuration gets the slots until it is shared by too many slaves.
+        TS_ASSERT_EQUALS(portfolio.start(), 0u);
+        TS_ASSERT_EQUALS(portfolio.start(), 0u);
+        TS_ASSERT_EQUALS(portfolio.start(), 2u);
+        TS_ASSERT_EQUALS(portfolio.stats[0].active, 2u);
+    }
+
+    void test_strip_decomposition()
+    {
+        strip_decomposition strips(3, 1.0);
+        strips.initialise(-100.0, 100.0, 0.0, 30.0);
+        TS_ASSERT_EQUALS(strips.boundaries(),
+                         (std::vector<double>{ -100.0, 10.0, 20.0, 100.0 }));
+        TS_ASSERT_EQUALS(strips.strip(0), std::make_pair(-100.0, 11.0));
+        TS_ASSERT_EQUALS(strips.strip(1), std::make_pair(9.0, 21.0));
+
+        auto final_column = [](double objective) {
+            column c{ time_of_flight(1, 1, {}),
+                      { objective, 0.0, objective, objective, 0.0, 1 } };
+            c.optimality = column::OPTIMAL;
+            return c;
+        };
+        // the best final column is only returned when all strips of the generation finished.
+        strips.start(5);
+        TS_ASSERT(!strips.finish(final_column(-1.0), 5));
+        TS_ASSERT(!strips.finish(final_column(3.0), 4));
+        TS_ASSERT(!strips.finish(final_column(-0.5), 5));
+        std::optional<column> best = strips.finish(final_column(-2.0), 5);
+        TS_ASSERT(best);
+        if (best) {
+            TS_ASSERT_EQUALS(best->stats.objective, -0.5);
+        }
+
+        for (double x : { 2.0, 3.0, 4.0, 25.0, 26.0, 27.0 }) {
+            strips.record(x);
+        }
+        strips.rebalance();
+        TS_ASSERT_EQUALS(strips.boundaries(),
+                         (std::vector<double>{ -100.0, 7.0, 23.0, 100.0 }));
+    }
 };
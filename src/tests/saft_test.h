@@ -21,6 +21,26 @@ class saft_test : public CxxTest::TestSuite
         //image.dump(std::cout);
     }
 
+    void test_grid_tofs()
+    {
+        config c;
+        c.elements = 4;
+        c.samples = 400;
+        c.roi_start = 100;
+        std::vector<time_of_flight> tofs;
+        saft{ 20, 40, c }.grid_tofs(tofs);
+
+        TS_ASSERT(!tofs.empty());
+        for (unsigned t = 0; t < tofs.size(); t++) {
+            TS_ASSERT(tofs[t].in_bounds(c.get_roi_start(), c.get_roi_end()));
+            TS_ASSERT(tofs[t].representant_x);
+            for (unsigned u = 0; u < t; u++) {
+                TS_ASSERT(!std::equal(
+                  tofs[t].begin(), tofs[t].end(), tofs[u].begin()));
+            }
+        }
+    }
+
     void test_saft_to_tof()
     {
         const unsigned width = 3000;
@@ -3,12 +3,17 @@
 
 #include "../optlib/coordinates.h"
 #include "../optlib/fftw_convolution.h"
+#include "../optlib/geometric_slave.h"
+#include "../optlib/grb_diagonal_slave.h"
 #include "../optlib/grb_slave.h"
 #include "../optlib/linear_expression.h"
 #include "../optlib/reader.h"
 #include "../optlib/simplexoid.h"
 #include "../optlib/slave_constraints_generator.h"
+#include "../optlib/threaded_slave.h"
+#include <memory>
 #include <numeric>
+#include <random>
 #include <variant>
 
 struct check_linear_expression
@@ -108,6 +113,17 @@ class slave_test : public CxxTest::TestSuite
         return std::sqrt(a * a + b * b - 2.0 * a * b * cosinus_gamma);
     }
 
+    /// The objective of the slave : the signal correlated with the reference.
+    void correlate(arr<>& signal, arr<>& ref, arr<>& convoluted)
+    {
+        fourier_convolution fc;
+        arr<> _convoluted(signal.dim1, signal.dim2, signal.dim3 + ref.dim3 - 1);
+        arr_1d<fftw_arr, double> inverted_ref(0, nullptr, false);
+        ref.invert(inverted_ref);
+        fc.convolve(signal, inverted_ref, _convoluted);
+        _convoluted.sub_to(convoluted, 0, 0, ref.dim3 - 1);
+    }
+
     double helper(arr<>& signal,
                   arr<>& ref,
                   columns& results,
@@ -127,14 +143,8 @@ class slave_test : public CxxTest::TestSuite
                     verbose ? new grb_to_file(std::cout) : grb_no_op_callback(),
                     verbose);
 
-        fourier_convolution fc;
-        arr<> _convoluted(signal.dim1, signal.dim2, signal.dim3 + ref.dim3 - 1);
-        arr_1d<fftw_arr, double> inverted_ref(0, nullptr, false);
-        ref.invert(inverted_ref);
-        fc.convolve(signal, inverted_ref, _convoluted);
-
         arr<> convoluted(signal.dim1, signal.dim2, signal.dim3);
-        _convoluted.sub_to(convoluted, 0, 0, ref.dim3 - 1);
+        correlate(signal, ref, convoluted);
 
         if (verbose) {
             std::cout << "Slave_test : " << convoluted << std::endl;
@@ -274,6 +284,61 @@ class slave_test : public CxxTest::TestSuite
         feasible(from_evil, to_distance, false, constraints, pitch);
     }
 
+    void test_reachable_k_ranges()
+    {
+        const unsigned elements = 8;
+        const unsigned offset = 20;
+        const unsigned samples = 60;
+        const double pitch = 3.0;
+        slave_constraint_generator scg{
+            { elements, elements, samples },
+            { [](unsigned k) { return k + offset; },
+              [](unsigned k) {
+                  return k >= offset ? std::optional(k - offset) : std::nullopt;
+              } },
+            pitch,
+        };
+        const auto ranges = scg.reachable_k_ranges(-80.0, 80.0);
+        TS_ASSERT_EQUALS(ranges.size(), elements * (elements + 1) / 2);
+
+        // every pixel whose tofs fit into the samples gives a feasible solution : d_ii is its distance, q_i = d_ii^2.
+        for (double x = -80.0; x <= 80.0; x += 0.5) {
+            for (double z = 0.0; z <= 80.0; z += 0.5) {
+                std::vector<double> d(elements);
+                bool inside = true;
+                for (unsigned e = 0; e < elements; e++) {
+                    d[e] = std::hypot(x - 2.0 * e * pitch, z);
+                    inside = inside && std::round(d[e]) >= offset &&
+                             std::round(d[e]) < offset + samples;
+                }
+                if (!inside) {
+                    continue;
+                }
+                unsigned p = 0;
+                for (unsigned i = 0; i < elements; i++) {
+                    for (unsigned j = i; j < elements; j++, p++) {
+                        const unsigned k =
+                          std::round(0.5 * (d[i] + d[j])) - offset;
+                        TS_ASSERT_LESS_THAN_EQUALS(ranges[p].first, k);
+                        TS_ASSERT_LESS_THAN_EQUALS(k, ranges[p].second);
+                    }
+                }
+            }
+        }
+        bool restricted = false;
+        for (const auto& range : ranges) {
+            restricted = restricted || range.second - range.first + 1 < samples;
+        }
+        TS_ASSERT(restricted);
+
+        // a smaller roi only shrinks the ranges.
+        const auto roi = scg.reachable_k_ranges(20.0, 30.0);
+        for (unsigned p = 0; p < ranges.size(); p++) {
+            TS_ASSERT_LESS_THAN_EQUALS(ranges[p].first, roi[p].first);
+            TS_ASSERT_LESS_THAN_EQUALS(roi[p].second, ranges[p].second);
+        }
+    }
+
     void test_constraint_pool_simple()
     {
         const unsigned elements = 16;
@@ -326,6 +391,420 @@ class slave_test : public CxxTest::TestSuite
     //    std::cout << "STRANGE_SIGNS" << std::endl;
     //}
 
+    void test_incremental_objective()
+    {
+        const unsigned elements = 2;
+        const unsigned samples = 96;
+        arr_1d<arr, double> reference(16);
+        reference.for_ijk([](unsigned, unsigned, unsigned k) {
+            return std::sin(0.8 * k) * (16.0 - k);
+        });
+
+        GRBEnv e;
+        grb_slave reused(&e,
+                         3,
+                         std::nullopt,
+                         0,
+                         std::nullopt,
+                         std::nullopt,
+                         std::cout,
+                         grb_no_op_callback(),
+                         false);
+
+        // the reused slave only updates the changed coefficients, a new slave builds its objective from scratch.
+        for (unsigned shift : { 20, 50, 50, 30 }) {
+            arr<unsigned> shifts(1, elements, elements);
+            shifts.for_ijk([&](unsigned, unsigned j, unsigned k) {
+                return shift + (j != k);
+            });
+            arr<> signal(elements, elements, samples);
+            helper_shifter(reference, shifts, signal);
+
+            arr<> convoluted(elements, elements, samples);
+            correlate(signal, reference, convoluted);
+            columns reused_results;
+            reused.run(convoluted, reused_results);
+
+            columns results;
+            double obj;
+            helper(signal, reference, results, obj);
+
+            TS_ASSERT(!reused_results.empty());
+            TS_ASSERT(!results.empty());
+            if (!reused_results.empty() && !results.empty()) {
+                TS_ASSERT_DELTA(reused_results[0].stats.objective,
+                                results[0].stats.objective,
+                                1e-6);
+            }
+        }
+    }
+
+    void test_presolve_keeps_optimum()
+    {
+        const unsigned elements = 3;
+        const unsigned samples = 80;
+        arr_1d<arr, double> reference(16);
+        reference.for_ijk([](unsigned, unsigned, unsigned k) {
+            return std::sin(0.8 * k) * (16.0 - k);
+        });
+
+        GRBEnv e;
+        auto create = [&](bool presolve) {
+            auto s = std::make_unique<grb_slave>(&e,
+                                                 3,
+                                                 std::nullopt,
+                                                 0,
+                                                 std::nullopt,
+                                                 std::nullopt,
+                                                 std::cout,
+                                                 grb_no_op_callback(),
+                                                 false);
+            s->presolve = presolve;
+            return s;
+        };
+        auto presolved = create(true);
+        auto full = create(false);
+
+        for (unsigned shift : { 30, 40, 40, 35 }) {
+            arr<unsigned> shifts(1, elements, elements);
+            shifts.for_ijk([&](unsigned, unsigned j, unsigned k) {
+                return shift + (j != k);
+            });
+            arr<> signal(elements, elements, samples);
+            helper_shifter(reference, shifts, signal);
+            arr<> convoluted(elements, elements, samples);
+            correlate(signal, reference, convoluted);
+
+            columns presolved_results, full_results;
+            presolved->run(convoluted, presolved_results);
+            full->run(convoluted, full_results);
+            TS_ASSERT(!presolved_results.empty());
+            TS_ASSERT(!full_results.empty());
+            if (!presolved_results.empty() && !full_results.empty()) {
+                TS_ASSERT_DELTA(presolved_results[0].stats.objective,
+                                full_results[0].stats.objective,
+                                1e-6);
+            }
+        }
+        // the geometry forbids short tofs between distant elements.
+        TS_ASSERT_LESS_THAN(0u, presolved->fixed_binaries);
+    }
+
+    void test_restrict_to_roi()
+    {
+        const unsigned elements = 3;
+        const unsigned samples = 80;
+        arr_1d<arr, double> reference(16);
+        reference.for_ijk([](unsigned, unsigned, unsigned k) {
+            return std::sin(0.8 * k) * (16.0 - k);
+        });
+
+        GRBEnv e;
+        auto create = [&](bool restrict_to_roi) {
+            auto s = std::make_unique<grb_slave>(&e,
+                                                 3,
+                                                 std::nullopt,
+                                                 0,
+                                                 std::nullopt,
+                                                 std::nullopt,
+                                                 std::cout,
+                                                 grb_no_op_callback(),
+                                                 false);
+            s->restrict_to_roi = restrict_to_roi;
+            return s;
+        };
+        auto restricted = create(true);
+        auto full = create(false);
+
+        // a strip and the strip next to it, like the strip slaves of grb_multiple_slave_async.
+        for (const auto& strip : { std::pair{ -10.0, 20.0 },
+                                   std::pair{ 20.0, 45.0 } }) {
+            restricted->set_horizontal_roi(strip.first, strip.second);
+            full->set_horizontal_roi(strip.first, strip.second);
+
+            arr<unsigned> shifts(1, elements, elements);
+            shifts.for_ijk(
+              [&](unsigned, unsigned j, unsigned k) { return 35 + (j != k); });
+            arr<> signal(elements, elements, samples);
+            helper_shifter(reference, shifts, signal);
+            arr<> convoluted(elements, elements, samples);
+            correlate(signal, reference, convoluted);
+
+            columns restricted_results, full_results;
+            restricted->run(convoluted, restricted_results);
+            full->run(convoluted, full_results);
+            TS_ASSERT(!restricted_results.empty());
+            TS_ASSERT(!full_results.empty());
+            if (!restricted_results.empty() && !full_results.empty()) {
+                TS_ASSERT_DELTA(restricted_results[0].stats.objective,
+                                full_results[0].stats.objective,
+                                1e-6);
+            }
+            // the strips forbid short tofs, also without the presolve.
+            TS_ASSERT_LESS_THAN(0u, restricted->fixed_binaries);
+            TS_ASSERT_EQUALS(full->fixed_binaries, 0u);
+        }
+    }
+
+    void test_geometric_slave_exact()
+    {
+        const unsigned elements = 3;
+        const unsigned samples = 50;
+        const unsigned offset = 10;
+        const double pitch = 3;
+        std::mt19937 generator(42);
+        std::normal_distribution<double> normal;
+        arr<> f(elements, elements, samples);
+        f.for_ijk([&](unsigned, unsigned, unsigned) { return normal(generator); });
+
+        geometric_slave s(
+          pitch, std::nullopt, offset, std::nullopt, std::nullopt, std::cout, false);
+        columns results;
+        s.run(f, results);
+        TS_ASSERT_EQUALS(results.size(), 1u);
+        const time_of_flight& tof = results[0].tof;
+        double objective = 0.0;
+        for (unsigned i = 0; i < elements; i++) {
+            for (unsigned j = 0; j < elements; j++) {
+                objective += f(i, j, tof.at(i, j) - offset);
+            }
+        }
+        TS_ASSERT_DELTA(objective, results[0].stats.objective, 1e-9);
+        TS_ASSERT_DELTA(results[0].stats.best_objective_bound, objective, 1e-9);
+
+        // no position of a fine grid beats the branch-and-bound.
+        for (double x = -(double)(samples + offset);
+             x < samples + offset + 4 * pitch;
+             x += 0.25) {
+            for (double y = 0.0; y < samples + offset; y += 0.25) {
+                if (std::optional<double> value = s.evaluate(x, y)) {
+                    TS_ASSERT_LESS_THAN_EQUALS(*value, objective + 1e-9);
+                }
+            }
+        }
+    }
+
+    void test_geometric_slave_coarse_bound()
+    {
+        const unsigned elements = 3;
+        const unsigned samples = 50;
+        const unsigned offset = 10;
+        const double pitch = 3;
+        std::mt19937 generator(42);
+        std::normal_distribution<double> normal;
+        arr<> f(elements, elements, samples);
+        f.for_ijk([&](unsigned, unsigned, unsigned) { return normal(generator); });
+
+        geometric_slave s(
+          pitch, std::nullopt, offset, std::nullopt, std::nullopt, std::cout, false);
+        // boxes are dropped before they are exact, their bounds must stay in the reported bound.
+        s.min_box_width = 8.0;
+        columns results;
+        s.run(f, results);
+        TS_ASSERT_EQUALS(results.size(), 1u);
+        const double bound = results[0].stats.best_objective_bound;
+        TS_ASSERT_LESS_THAN_EQUALS(results[0].stats.objective, bound);
+        for (double x = -(double)(samples + offset);
+             x < samples + offset + 4 * pitch;
+             x += 0.25) {
+            for (double y = 0.0; y < samples + offset; y += 0.25) {
+                if (std::optional<double> value = s.evaluate(x, y)) {
+                    TS_ASSERT_LESS_THAN_EQUALS(*value, bound + 1e-9);
+                }
+            }
+        }
+    }
+
+    void test_threaded_slave()
+    {
+        const unsigned elements = 3;
+        const unsigned samples = 50;
+        const unsigned offset = 10;
+        const double pitch = 3;
+        std::mt19937 generator(7);
+        std::normal_distribution<double> normal;
+        arr<> f(elements, elements, samples);
+        f.for_ijk([&](unsigned, unsigned, unsigned) { return normal(generator); });
+
+        geometric_slave sync(
+          pitch, std::nullopt, offset, std::nullopt, std::nullopt, std::cout, false);
+        columns expected;
+        sync.run(f, expected);
+
+        constraint_pool pool;
+        threaded_slave s(
+          [&](std::ostream& output) {
+              return std::make_unique<geometric_slave>(pitch,
+                                                       std::nullopt,
+                                                       offset,
+                                                       std::nullopt,
+                                                       std::nullopt,
+                                                       output,
+                                                       true);
+          },
+          pool,
+          std::cout);
+        columns results;
+        s.run(f, results);
+        TS_ASSERT(results.empty());
+        // the slave works on a copy.
+        f.for_ijk([](unsigned, unsigned, unsigned) { return 0.0; });
+
+        // the final column reaches the master even though it does not separate.
+        pool.consume(
+          results, [](column_with_origin&) { return 0.0; }, 1.0);
+        s.cancel();
+        TS_ASSERT(s.ready());
+        TS_ASSERT_EQUALS(results.size(), 1u);
+        if (!results.empty()) {
+            TS_ASSERT_DIFFERS(results[0].optimality, column::NON_OPTIMAL);
+            TS_ASSERT_DELTA(
+              results[0].stats.objective, expected[0].stats.objective, 1e-9);
+            TS_ASSERT(results[0].tof.at(1, 2) == expected[0].tof.at(1, 2));
+        }
+        TS_ASSERT_LESS_THAN(0.0, s.busy_time());
+    }
+
+    void test_geometric_slave_like_grb_slave()
+    {
+        const unsigned elements = 4;
+        const unsigned samples = 120;
+        const double pitch = 3;
+        arr_1d<arr, double> reference(16);
+        reference.for_ijk([](unsigned, unsigned, unsigned k) {
+            return std::sin(0.8 * k) * (16.0 - k);
+        });
+
+        // the signal of a reflector at (x, y), in the units of the slaves.
+        const double x = 7.0, y = 60.0;
+        arr<unsigned> shifts(1, elements, elements);
+        shifts.for_ijk([&](unsigned, unsigned i, unsigned j) {
+            const double d_i = std::hypot(x - 2.0 * i * pitch, y);
+            const double d_j = std::hypot(x - 2.0 * j * pitch, y);
+            return (unsigned)std::floor(0.5 * (d_i + d_j));
+        });
+        arr<> signal(elements, elements, samples);
+        helper_shifter(reference, shifts, signal);
+        arr<> convoluted(elements, elements, samples);
+        correlate(signal, reference, convoluted);
+
+        geometric_slave geometric(
+          pitch, std::nullopt, 0, std::nullopt, std::nullopt, std::cout, false);
+        columns geometric_results;
+        geometric.run(convoluted, geometric_results);
+
+        columns results;
+        double obj;
+        helper(signal, reference, results, obj);
+
+        TS_ASSERT(!geometric_results.empty());
+        TS_ASSERT(!results.empty());
+        if (!geometric_results.empty() && !results.empty()) {
+            TS_ASSERT_DELTA(geometric_results[0].stats.objective,
+                            results[0].stats.objective,
+                            1e-6);
+            TS_ASSERT_DELTA(geometric_results[0].tof.dot_product_with_dual(
+                              reference, signal, 0),
+                            geometric_results[0].stats.objective,
+                            0.1);
+        }
+    }
+
+    void test_diagonal_slave()
+    {
+        const unsigned elements = 4;
+        const unsigned samples = 120;
+        const double pitch = 3;
+        arr_1d<arr, double> reference(16);
+        reference.for_ijk([](unsigned, unsigned, unsigned k) {
+            return std::sin(0.8 * k) * (16.0 - k);
+        });
+
+        const double x = 7.0, y = 60.0;
+        arr<unsigned> shifts(1, elements, elements);
+        shifts.for_ijk([&](unsigned, unsigned i, unsigned j) {
+            const double d_i = std::hypot(x - 2.0 * i * pitch, y);
+            const double d_j = std::hypot(x - 2.0 * j * pitch, y);
+            return (unsigned)std::floor(0.5 * (d_i + d_j));
+        });
+        arr<> signal(elements, elements, samples);
+        helper_shifter(reference, shifts, signal);
+        arr<> convoluted(elements, elements, samples);
+        correlate(signal, reference, convoluted);
+
+        columns results;
+        double obj;
+        helper(signal, reference, results, obj);
+        TS_ASSERT(!results.empty());
+
+        GRBEnv e;
+        for (double threshold : { 0.0, 1e9 }) {
+            grb_diagonal_slave s(&e,
+                                 pitch,
+                                 std::nullopt,
+                                 0,
+                                 std::nullopt,
+                                 std::nullopt,
+                                 threshold,
+                                 std::cout,
+                                 grb_no_op_callback(),
+                                 false);
+            columns diagonal_results;
+            s.run(convoluted, diagonal_results);
+            TS_ASSERT_EQUALS(diagonal_results.size(), 1u);
+            if (diagonal_results.empty() || results.empty()) {
+                continue;
+            }
+            const column& c = diagonal_results[0];
+            // the objective is the reduced cost of the completed column, which the full slave bounds.
+            TS_ASSERT_DELTA(
+              c.tof.dot_product_with_dual(reference, signal, 0),
+              c.stats.objective,
+              0.1);
+            TS_ASSERT_LESS_THAN_EQUALS(c.stats.objective,
+                                       results[0].stats.objective + 1e-6);
+            if (threshold == 0.0) {
+                TS_ASSERT_EQUALS(s.compact_columns, 1u);
+                TS_ASSERT_EQUALS(s.vars_proxy.size(), elements * samples);
+            } else {
+                // nothing beats the threshold: the full slave answers.
+                TS_ASSERT_EQUALS(s.compact_columns, 0u);
+                TS_ASSERT_DELTA(
+                  c.stats.objective, results[0].stats.objective, 1e-6);
+            }
+        }
+
+        // in the async column generation, the proven column of the full slave reaches the pool as optimal.
+        constraint_pool pool;
+        threaded_slave threaded(
+          [&](std::ostream& output) {
+              return std::make_unique<grb_diagonal_slave>(&e,
+                                                          pitch,
+                                                          std::nullopt,
+                                                          0,
+                                                          std::nullopt,
+                                                          std::nullopt,
+                                                          1e9,
+                                                          output,
+                                                          grb_no_op_callback(),
+                                                          false);
+          },
+          pool,
+          std::cout);
+        columns threaded_results;
+        threaded.run(convoluted, threaded_results);
+        pool.consume(
+          threaded_results, [](column_with_origin&) { return 0.0; }, 1.0);
+        threaded.cancel();
+        TS_ASSERT_EQUALS(threaded_results.size(), 1u);
+        if (!threaded_results.empty() && !results.empty()) {
+            TS_ASSERT_EQUALS(threaded_results[0].optimality, column::OPTIMAL);
+            TS_ASSERT_DELTA(threaded_results[0].stats.objective,
+                            results[0].stats.objective,
+                            1e-6);
+        }
+    }
+
     void test_shifted_reference()
     {
         civa_txt_reader r;